@@ -103,4 +103,4 @@ namespace reflect::assert {
 
 #define reflect_todo(...) ( \
     ::reflect::assert::todo(_reflect_location, ##__VA_ARGS__) \
-)
\ No newline at end of file
+)
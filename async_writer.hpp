@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "writer.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  async_writer
+    //
+    //  Buffers writes and hands each filled buffer to a dedicated thread which
+    //  writes it to the target writer, e.g. a stream_writer or fd_writer, so
+    //  that encoding overlaps with I/O.  With the default two buffers, one is
+    //  filled while the other is written.  When every buffer is in flight the
+    //  writing thread waits for one to be written, which bounds the memory
+    //  used when the target is slower than the encoder.
+    //
+    //  The target is only used by the I/O thread until the async_writer is
+    //  flushed or destroyed.  Once the target fails, the async_writer is false
+    //  and further buffers are discarded.
+    //
+    //  EXAMPLE:
+    //
+    //      std::ofstream file("export.ndjson");
+    //      reflect::stream_writer target(file);
+    //      reflect::async_writer writer(target);
+    //      json::encoder encoder(writer);
+    //      for (auto& record : records) {
+    //          encoder.reset(writer);
+    //          encoder(record);
+    //          writer.write('\n');
+    //      }
+    //      writer.flush();
+    //
+    class async_writer final : public writer {
+
+        writer& _target;
+
+        const size_t _capacity;
+
+        std::vector<char> _buffer;
+
+        size_t _offset = 0;
+
+        size_t _stalls = 0;
+
+        std::mutex _mutex;
+
+        std::condition_variable _submitted;
+
+        std::condition_variable _written;
+
+        std::deque<std::vector<char>> _pending;
+
+        std::vector<std::vector<char>> _free;
+
+        bool _writing = false;
+
+        bool _stopping = false;
+
+        std::atomic<bool> _failed { false };
+
+        std::thread _thread;
+
+    public: // structors
+
+        //  Hands off buffers of about capacity bytes, with at most buffers
+        //  of them, including the one being filled, in use at once.
+        explicit async_writer(
+            writer& target,
+            size_t capacity = 1 << 20,
+            size_t buffers = 2)
+        :_target(target)
+        ,_capacity(capacity) {
+            _buffer.reserve(capacity);
+            for (size_t i = 1; i < std::max<size_t>(buffers,2); ++i) {
+                _free.emplace_back().reserve(capacity);
+            }
+            _thread = std::thread([this]{ run(); });
+        }
+
+        ~async_writer() {
+            flush();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _submitted.notify_one();
+            _thread.join();
+        }
+
+    public: // properties
+
+        //  The number of times a full buffer had to wait for the I/O thread.
+        size_t stalls() const { return _stalls; }
+
+    public: // overrides
+
+        using writer::write;
+
+        explicit operator bool() const override {
+            return not _failed.load(std::memory_order_relaxed);
+        }
+
+        size_t offset() const override { return _offset; }
+
+        void write(const char* s, size_t n) override {
+            _offset += n;
+            _buffer.insert(_buffer.end(),s,s+n);
+            if (_buffer.size() >= _capacity) {
+                submit();
+            }
+        }
+
+    public: // synchronization
+
+        //  Hands the bytes written so far to the I/O thread without waiting
+        //  for them to be written, unless every buffer is in flight.
+        void submit() {
+            if (_buffer.empty()) return;
+            std::unique_lock<std::mutex> lock(_mutex);
+            _pending.push_back(std::move(_buffer));
+            _submitted.notify_one();
+            if (_free.empty()) {
+                _stalls += 1;
+                _written.wait(lock,[&]{ return not _free.empty(); });
+            }
+            _buffer = std::move(_free.back());
+            _free.pop_back();
+        }
+
+        //  Waits until every byte written so far has been written to the
+        //  target, after which the target may be used directly.  Returns
+        //  false if the target failed.
+        bool flush() {
+            submit();
+            std::unique_lock<std::mutex> lock(_mutex);
+            _written.wait(lock,[&]{ return _pending.empty() and not _writing; });
+            return operator bool();
+        }
+
+    private: // I/O thread
+
+        void run() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;) {
+                _submitted.wait(lock,[&]{
+                    return _stopping or not _pending.empty();
+                });
+                if (_pending.empty()) return;
+                std::vector<char> buffer = std::move(_pending.front());
+                _pending.pop_front();
+                _writing = true;
+                lock.unlock();
+                if (not _failed.load(std::memory_order_relaxed)) {
+                    _target.write(buffer.data(),buffer.size());
+                    if (not _target) {
+                        _failed.store(true,std::memory_order_relaxed);
+                    }
+                }
+                buffer.clear();
+                lock.lock();
+                _writing = false;
+                _free.push_back(std::move(buffer));
+                _written.notify_all();
+            }
+        }
+
+    };
+
+} // namespace reflect
@@ -0,0 +1,435 @@
+//------------------------------------------------------------------------------
+//  reflect codec benchmarks
+//
+//  Generates synthetic datasets from a fixed seed, then measures encoding
+//  and decoding throughput for each combination of reader and writer.
+//  The same seed always produces the same bytes, so results are directly
+//  comparable between builds.
+//
+//  USAGE:
+//
+//      bench [--seed N] [--scale N] [--repeat N] [--filter TEXT] [--csv]
+//
+//      --seed      seed of the dataset generator (default 1)
+//      --scale     multiplies the number of objects in each dataset
+//      --repeat    runs per measurement, the fastest is reported (default 5)
+//      --filter    only run datasets whose name contains TEXT
+//      --csv       print comma-separated values instead of a table
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <reflect/fd_writer.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace json = reflect::codecs::json;
+
+//------------------------------------------------------------------------------
+//  datasets
+
+// string-heavy log events
+struct event {
+    reflect_fields(
+        ((std::string),id),
+        ((std::string),type),
+        ((std::string),user),
+        ((std::string),message),
+        ((int64_t),timestamp),
+        ((bool),acknowledged)
+    )
+};
+
+// number-heavy samples
+struct sample {
+    reflect_fields(
+        ((double),x),
+        ((double),y),
+        ((double),z),
+        ((int),quality),
+        ((std::vector<float>),spectrum)
+    )
+};
+
+// deeply nested configuration
+struct node {
+    reflect_fields(
+        ((std::string),name),
+        ((int),priority),
+        ((bool),enabled),
+        ((std::vector<node>),children)
+    )
+};
+
+// wide records
+struct record {
+    reflect_fields(
+        ((int),f00), ((int),f01), ((int),f02), ((int),f03),
+        ((double),f04), ((double),f05), ((double),f06), ((double),f07),
+        ((bool),f08), ((bool),f09), ((bool),f10), ((bool),f11),
+        ((std::string),f12), ((std::string),f13), ((std::string),f14),
+        ((std::string),f15), ((int64_t),f16), ((int64_t),f17),
+        ((int64_t),f18), ((int64_t),f19), ((float),f20), ((float),f21),
+        ((float),f22), ((float),f23), ((unsigned),f24), ((unsigned),f25),
+        ((unsigned),f26), ((unsigned),f27), ((short),f28), ((short),f29),
+        ((short),f30), ((short),f31)
+    )
+};
+
+//------------------------------------------------------------------------------
+//  generator
+
+class generator {
+    std::mt19937_64 _engine;
+
+public: // structors
+
+    explicit generator(uint64_t seed)
+    :_engine(seed) {}
+
+public: // primitives
+
+    int64_t integer(int64_t min, int64_t max) {
+        return std::uniform_int_distribution<int64_t>(min,max)(_engine);
+    }
+
+    double real(double min, double max) {
+        return std::uniform_real_distribution<double>(min,max)(_engine);
+    }
+
+    bool boolean() { return integer(0,1); }
+
+    std::string word(size_t min, size_t max) {
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+        std::string s(size_t(integer(min,max)),' ');
+        for (char& c : s) c = letters[integer(0,25)];
+        return s;
+    }
+
+    //  Roughly one in eight sentences contains characters that must be
+    //  escaped, as real log messages do.
+    std::string sentence(size_t words) {
+        std::string s;
+        for (size_t i = 0; i < words; ++i) {
+            if (i) s += ' ';
+            s += word(1,10);
+        }
+        switch (integer(0,15)) {
+            case 0: s += " \"quoted\""; break;
+            case 1: s += "\n\tat frame"; break;
+            case 2: s += " C:\\path\\to\\file"; break;
+        }
+        return s;
+    }
+
+public: // datasets
+
+    std::vector<event> events(size_t n) {
+        static const char* const types[] = {"info","warning","error","debug"};
+        std::vector<event> v(n);
+        for (event& e : v) {
+            e.id = word(16,16);
+            e.type = types[integer(0,3)];
+            e.user = word(4,12) + "@" + word(4,8) + ".com";
+            e.message = sentence(size_t(integer(4,24)));
+            e.timestamp = integer(1500000000000,1700000000000);
+            e.acknowledged = boolean();
+        }
+        return v;
+    }
+
+    std::vector<sample> samples(size_t n) {
+        std::vector<sample> v(n);
+        for (sample& s : v) {
+            s.x = real(-1e3,1e3);
+            s.y = real(-1e3,1e3);
+            s.z = real(-1e3,1e3);
+            s.quality = int(integer(0,100));
+            s.spectrum.resize(16);
+            for (float& f : s.spectrum) f = float(real(0,1));
+        }
+        return v;
+    }
+
+    node tree(unsigned depth, unsigned fanout) {
+        node n;
+        n.name = word(4,16);
+        n.priority = int(integer(-10,10));
+        n.enabled = boolean();
+        if (depth) {
+            // mostly deep and narrow, occasionally bushy
+            const auto width = integer(1,fanout);
+            for (int64_t i = 0; i < width; ++i) {
+                n.children.push_back(tree(depth-1,i ? 1 : fanout));
+            }
+        }
+        return n;
+    }
+
+    std::vector<record> records(size_t n) {
+        std::vector<record> v(n);
+        for (record& r : v) {
+            r.f00 = int(integer(-1000,1000)); r.f01 = int(integer(0,1<<30));
+            r.f02 = int(integer(-9,9)); r.f03 = int(integer(0,100000));
+            r.f04 = real(-1,1); r.f05 = real(0,1e6);
+            r.f06 = real(-1e-3,1e-3); r.f07 = real(0,100);
+            r.f08 = boolean(); r.f09 = boolean();
+            r.f10 = boolean(); r.f11 = boolean();
+            r.f12 = word(1,8); r.f13 = word(8,16);
+            r.f14 = word(0,4); r.f15 = sentence(3);
+            r.f16 = integer(INT64_MIN/2,INT64_MAX/2);
+            r.f17 = integer(0,1<<20);
+            r.f18 = integer(-1,1); r.f19 = integer(0,INT64_MAX/2);
+            r.f20 = float(real(0,1)); r.f21 = float(real(-100,100));
+            r.f22 = float(real(0,1e4)); r.f23 = float(real(-1,1));
+            r.f24 = unsigned(integer(0,255)); r.f25 = unsigned(integer(0,1<<16));
+            r.f26 = unsigned(integer(0,1<<30)); r.f27 = unsigned(integer(0,9));
+            r.f28 = short(integer(-300,300)); r.f29 = short(integer(0,9));
+            r.f30 = short(integer(-9,0)); r.f31 = short(integer(0,32000));
+        }
+        return v;
+    }
+
+    std::map<std::string,int64_t> ordered_map(size_t n) {
+        std::map<std::string,int64_t> m;
+        while (m.size() < n) m.emplace(word(6,20),integer(0,1<<30));
+        return m;
+    }
+
+    std::unordered_map<std::string,std::string> unordered_map(size_t n) {
+        std::unordered_map<std::string,std::string> m;
+        while (m.size() < n) m.emplace(word(6,20),word(0,32));
+        return m;
+    }
+
+    std::map<int,double> integer_map(size_t n) {
+        std::map<int,double> m;
+        while (m.size() < n) m.emplace(int(integer(0,1<<30)),real(-1,1));
+        return m;
+    }
+};
+
+//------------------------------------------------------------------------------
+//  measurement
+
+struct options {
+    uint64_t seed = 1;
+    size_t scale = 1;
+    unsigned repeat = 5;
+    const char* filter = "";
+    bool csv = false;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+//  Returns the fastest of repeated runs, in nanoseconds.
+static double fastest(unsigned repeat, const std::function<bool()>& run) {
+    double best = 0;
+    for (unsigned i = 0; i < repeat; ++i) {
+        const auto start = clock_type::now();
+        if (not run()) return -1;
+        const std::chrono::duration<double,std::nano> ns =
+            clock_type::now() - start;
+        if (i == 0 or ns.count() < best) best = ns.count();
+    }
+    return best;
+}
+
+static void report(
+    const options& opts,
+    const char* dataset,
+    const char* operation,
+    const char* io,
+    size_t bytes,
+    size_t objects,
+    double ns)
+{
+    if (ns < 0) {
+        std::printf(opts.csv ? "%s,%s,%s,failed\n" : "%-14s %-7s %-14s failed\n",
+            dataset,operation,io);
+        return;
+    }
+    const double mb_per_s = double(bytes) / (1024.0 * 1024.0) / (ns * 1e-9);
+    const double ns_per_object = ns / double(objects);
+    std::printf(
+        opts.csv
+        ? "%s,%s,%s,%zu,%zu,%.1f,%.1f\n"
+        : "%-14s %-7s %-14s %10zu %9zu %10.1f %12.1f\n",
+        dataset,operation,io,bytes,objects,mb_per_s,ns_per_object);
+}
+
+template<typename T>
+struct is_unordered : std::false_type {};
+
+template<typename K, typename T>
+struct is_unordered<std::unordered_map<K,T>> : std::true_type {};
+
+//  Decoded values must encode to the original bytes, except for unordered
+//  containers, whose encoding depends on their insertion history.
+template<typename T>
+static bool round_trips(
+    const T& value,
+    const T& decoded,
+    const std::vector<char>& bytes,
+    const std::vector<char>& check)
+{
+    if constexpr(is_unordered<T>::value) {
+        return decoded == value;
+    } else {
+        return check == bytes;
+    }
+}
+
+//  Measures encoding and decoding of value with every reader and writer,
+//  and verifies that the decoded value encodes to identical bytes.
+template<typename T>
+static void run(
+    const options& opts,
+    const char* dataset,
+    const T& value,
+    size_t objects)
+{
+    if (not std::strstr(dataset,opts.filter)) return;
+
+    std::vector<char> bytes;
+    {
+        reflect::vector_writer writer(bytes);
+        json::encoder encoder(writer);
+        encoder(value);
+    }
+    const size_t size = bytes.size();
+    const std::string text(bytes.data(),size);
+
+    report(opts,dataset,"encode","vector_writer",size,objects,
+        fastest(opts.repeat,[&]{
+            std::vector<char> out;
+            out.reserve(size);
+            reflect::vector_writer writer(out);
+            json::encoder encoder(writer);
+            encoder(value);
+            return out.size() == size;
+        }));
+
+    report(opts,dataset,"encode","stream_writer",size,objects,
+        fastest(opts.repeat,[&]{
+            std::ostringstream out;
+            reflect::stream_writer writer(out);
+            json::encoder encoder(writer);
+            encoder(value);
+            return writer.offset() == size;
+        }));
+
+    // to /dev/null, measuring the writer rather than the device
+    const int null_fd = open("/dev/null",O_WRONLY);
+    report(opts,dataset,"encode","fd_writer",size,objects,
+        fastest(opts.repeat,[&]{
+            reflect::fd_writer writer(null_fd);
+            json::encoder encoder(writer);
+            encoder(value);
+            return writer.flush() and writer.offset() == size;
+        }));
+    close(null_fd);
+
+    T decoded;
+
+    report(opts,dataset,"decode","string_reader",size,objects,
+        fastest(opts.repeat,[&]{
+            decoded = T();
+            reflect::string_reader reader(text);
+            json::decoder decoder(reader);
+            return decoder(decoded) and not decoder.error();
+        }));
+
+    report(opts,dataset,"decode","stream_reader",size,objects,
+        fastest(opts.repeat,[&]{
+            decoded = T();
+            std::istringstream in(text);
+            reflect::stream_reader reader(in);
+            json::decoder decoder(reader);
+            return decoder(decoded) and not decoder.error();
+        }));
+
+    std::vector<char> check;
+    reflect::vector_writer writer(check);
+    json::encoder encoder(writer);
+    encoder(decoded);
+    if (not round_trips(value,decoded,bytes,check)) {
+        std::printf("%s: decoded value does not round-trip\n",dataset);
+    }
+}
+
+static size_t count(const node& n) {
+    size_t c = 1;
+    for (const node& child : n.children) c += count(child);
+    return c;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* const next = (i + 1 < argc) ? argv[i+1] : nullptr;
+        if (arg == "--csv") {
+            opts.csv = true;
+        } else if (arg == "--seed" and next) {
+            opts.seed = std::strtoull(argv[++i],nullptr,10);
+        } else if (arg == "--scale" and next) {
+            opts.scale = std::max<size_t>(1,std::strtoull(argv[++i],nullptr,10));
+        } else if (arg == "--repeat" and next) {
+            opts.repeat = std::max(1,std::atoi(argv[++i]));
+        } else if (arg == "--filter" and next) {
+            opts.filter = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                "usage: %s [--seed N] [--scale N] [--repeat N] "
+                "[--filter TEXT] [--csv]\n",argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf(
+        opts.csv
+        ? "dataset,operation,io,bytes,objects,MB/s,ns/object\n"
+        : "%-14s %-7s %-14s %10s %9s %10s %12s\n",
+        "dataset","operation","io","bytes","objects","MB/s","ns/object");
+
+    generator gen(opts.seed);
+    const size_t n = opts.scale;
+
+    const auto events = gen.events(20000*n);
+    run(opts,"events",events,events.size());
+
+    const auto samples = gen.samples(20000*n);
+    run(opts,"samples",samples,samples.size());
+
+    std::vector<node> configs;
+    for (size_t i = 0; i < 4*n; ++i) configs.push_back(gen.tree(64,3));
+    size_t nodes = 0;
+    for (const node& c : configs) nodes += count(c);
+    run(opts,"configs",configs,nodes);
+
+    const auto records = gen.records(10000*n);
+    run(opts,"records",records,records.size());
+
+    const auto ordered = gen.ordered_map(50000*n);
+    run(opts,"map",ordered,ordered.size());
+
+    const auto unordered = gen.unordered_map(50000*n);
+    run(opts,"unordered_map",unordered,unordered.size());
+
+    const auto integers = gen.integer_map(50000*n);
+    run(opts,"integer_map",integers,integers.size());
+
+    return 0;
+}
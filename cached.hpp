@@ -0,0 +1,210 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "reflect.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  fragment_cache
+    //
+    //  The bytes most recently encoded for a cached<T> value, and the context
+    //  they were encoded in, e.g. the codec, its preferences and nesting
+    //  depth, as identified by the codec.  Caches of nested cached<T> values
+    //  link to the cache of the nearest enclosing one, so that invalidating
+    //  a nested value also invalidates the fragments containing it.
+    //
+    //  Since a const value may be encoded by several threads at once, the
+    //  fragment and link are only accessed atomically, and a fragment is
+    //  never changed once published; a codec encodes a new one aside.
+    //
+    struct fragment_cache {
+
+        struct fragment {
+            std::vector<char> bytes;
+            uint64_t context = 0;
+        };
+
+        //  Returns the valid fragment, or null.
+        std::shared_ptr<const fragment> load() const {
+            return std::atomic_load(&_fragment);
+        }
+
+        //  Publishes desired if expected is still the valid fragment, and
+        //  returns the fragment which is valid afterwards.
+        std::shared_ptr<const fragment> publish(
+            std::shared_ptr<const fragment> expected,
+            const std::shared_ptr<const fragment>& desired)
+        {
+            if (std::atomic_compare_exchange_strong(&_fragment,&expected,desired)) {
+                return desired;
+            }
+            return expected;
+        }
+
+        //  Links this cache to that of the nearest enclosing cached value.
+        void link(const std::shared_ptr<fragment_cache>& parent) {
+            if (std::atomic_load(&_parent) != parent) {
+                std::atomic_store(&_parent,parent);
+            }
+        }
+
+        std::shared_ptr<fragment_cache> parent() const {
+            return std::atomic_load(&_parent);
+        }
+
+        //  Invalidates this fragment and those enclosing it.  An invalid
+        //  fragment's enclosing fragments are already invalid.
+        void invalidate() {
+            for (fragment_cache* cache = this; cache;) {
+                const std::shared_ptr<const fragment> none;
+                if (not std::atomic_exchange(&cache->_fragment,none)) break;
+                // the parent is kept alive by the link being followed
+                cache = cache->parent().get();
+            }
+        }
+
+    private:
+
+        std::shared_ptr<const fragment> _fragment;
+
+        std::shared_ptr<fragment_cache> _parent;
+    };
+
+    //--------------------------------------------------------------------------
+    //  cached<T>
+    //
+    //  Wraps a value of an object type whose encoding is cached by codecs
+    //  which support it, e.g. json::encoder, so that re-encoding a large and
+    //  mostly unchanged document splices in the bytes of unchanged subtrees
+    //  rather than encoding them again.  Codecs without support encode and
+    //  decode the value as if it were not wrapped.
+    //
+    //  Changes must be made through edit(), or followed by touch(), so that
+    //  the cache of this value and any cached values enclosing it is
+    //  invalidated.  A reference returned by edit() should not be kept for
+    //  changes after the next encoding.
+    //
+    //  Codecs lend the cached bytes to their writer, e.g. by
+    //  writer::write_borrowed(), so writers must be flushed before the value
+    //  is changed, or encoded in another context, e.g. with other
+    //  preferences or at another depth, either of which releases the bytes.
+    //  A value which is not changed may be encoded by several threads at
+    //  once in the same context.
+    //
+    //  Moving a cached value moves its cache, while copying one does not.
+    //
+    //  EXAMPLE:
+    //
+    //      struct config {
+    //          reflect_fields(
+    //              ((reflect::cached<route_table>),routes),
+    //              ((reflect::cached<limit_set>),limits));
+    //      };
+    //
+    //      c.limits.edit().max_connections = 512;
+    //      encoder(c); // routes are spliced from the cache
+    //
+    template<typename T>
+    class cached {
+
+        static_assert(is_object_v<T>, "cached<T> requires an object type");
+
+        T _value;
+
+        mutable std::shared_ptr<fragment_cache> _cache;
+
+    public: // structors
+
+        cached() = default;
+
+        cached(const T& value)
+        :_value(value) {}
+
+        cached(T&& value)
+        :_value(std::move(value)) {}
+
+        cached(const cached& other)
+        :_value(other._value) {}
+
+        cached(cached&& other)
+        :_value(std::move(other._value))
+        ,_cache(std::move(other._cache)) {}
+
+        cached& operator=(const cached& other) {
+            _value = other._value;
+            touch();
+            return *this;
+        }
+
+        cached& operator=(cached&& other) {
+            _value = std::move(other._value);
+            if (other._cache) {
+                // nested values moved along still link to other's cache
+                const auto parent = _cache ? _cache->parent() : nullptr;
+                _cache = std::move(other._cache);
+                _cache->link(parent);
+            }
+            touch();
+            return *this;
+        }
+
+    public: // properties
+
+        const T& value() const { return _value; }
+
+        const T& operator*() const { return _value; }
+
+        const T* operator->() const { return &_value; }
+
+        //  Returns the value for changing, invalidating its cache.
+        T& edit() {
+            touch();
+            return _value;
+        }
+
+        //  Invalidates the cache after the value has been changed in place.
+        void touch() {
+            if (_cache) _cache->invalidate();
+        }
+
+    public: // caching
+
+        //  The cache of the encoded value, for use by codecs, created on
+        //  first use by whichever thread encodes the value first.
+        std::shared_ptr<fragment_cache> cache() const {
+            auto cache = std::atomic_load(&_cache);
+            if (not cache) {
+                auto created = std::make_shared<fragment_cache>();
+                if (std::atomic_compare_exchange_strong(&_cache,&cache,created)) {
+                    cache = std::move(created);
+                }
+            }
+            return cache;
+        }
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    struct is_cached : std::false_type {};
+
+    template<typename T>
+    struct is_cached<cached<T>> : std::true_type {};
+
+    template<typename T>
+    static inline constexpr bool is_cached_v { is_cached<T>::value };
+
+} // namespace reflect
+
+reflect_decode_template((typename T),(reflect::cached<T>)) {
+    ::reflect::decode<T>(reflect,value.edit());
+}
+
+reflect_encode_template((typename T),(reflect::cached<T>)) {
+    ::reflect::encode<T>(reflect,value.value());
+}
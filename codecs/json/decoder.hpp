@@ -1,15 +1,28 @@
 #pragma once
+#include <cstring>
+#include <limits>
 #include <vector>
 #include <sstream>
+#include "statistics.hpp"
+#include "syntax.hpp"
 #include "token.hpp"
+#include "visitor.hpp"
 #include "../../assert.hpp"
 #include "../../read_error.hpp"
 
 namespace reflect::codecs::json {
 
-    class decoder {
+    //  lenient decoding skips unwanted values by their tokens alone, while
+    //  strict decoding also verifies the structure of skipped values, that
+    //  values have the expected type, and that nothing follows the document
+    enum class validation : char { lenient, strict };
 
-        reader* const _reader = reader::null;
+    //  The accepted dialect is fixed at compile time by the Syntax policy,
+    //  see syntax.hpp; rejected extensions cost nothing in the hot loops.
+    template<typename Syntax = syntax::lenient>
+    class basic_decoder {
+
+        reader* _reader = reader::null;
 
         read_error _error;
 
@@ -17,46 +30,149 @@ namespace reflect::codecs::json {
 
         std::vector<uint16_t> _utf16;
 
-        std::string _property_key;
+        unsigned _depth = 0;
+
+        validation _validation = validation::lenient;
+
+        #if reflect_codecs_json_statistics
+        decoder_statistics _statistics;
+        size_t _read_end = 0;
+        #endif
+
+    public: // types
+
+        using syntax_type = Syntax;
 
     public: // structors
 
-        decoder() = default;
+        basic_decoder() = default;
+
+        basic_decoder(
+            reader& reader,
+            validation validation = validation::lenient)
+        :_reader(&reader)
+        ,_validation(validation) {}
+
+    public: // session
+
+        //  Rebinds the decoder to a new reader and clears its error, keeping
+        //  the capacity of its scratch buffers for the next message.
+        void reset(reader& reader) {
+            _reader = &reader;
+            reset();
+        }
+
+        void reset() {
+            _error = {};
+            _depth = 0;
+            _utf8.clear();
+            _utf16.clear();
+            #if reflect_codecs_json_statistics
+            _read_end = 0;
+            #endif
+        }
 
-        decoder(reader& reader):_reader(&reader) {}
+        //  The bytes reserved by the scratch buffers kept across reset().
+        size_t capacity() const {
+            return _utf8.capacity() + _utf16.capacity() * sizeof(uint16_t);
+        }
 
     public: // validation
 
         read_error error() const { return _error; }
 
+        size_t offset() const { return _reader->offset(); }
+
+        const decoder_statistics& statistics() const {
+            #if reflect_codecs_json_statistics
+            return _statistics;
+            #else
+            static const decoder_statistics none;
+            return none;
+            #endif
+        }
+
         read_error validate();
 
+    public: // visitation
+
+        template<typename Visitor>
+        read_error visit(Visitor& visitor);
+
+        template<typename Visitor>
+        bool visit_value(Visitor& visitor);
+
     public: // decoding
 
         template<typename T>
         bool operator()(T& out) {
-            return parse_value(out);
+            return delegate(*this, out);
         }
 
         template<typename T>
         bool operator()(substring key, T& out) {
-            return parse_property(key, out);
+            return delegate(*this, key, out);
+        }
+
+        bool operator()(substring* key) {
+            return parse_property(key);
         }
 
         template<typename T>
         bool operator()(substring* key, T& out) {
-            return parse_property(key, out);
+            return delegate(*this, key, out);
+        }
+
+    public: // delegation
+
+        //  As operator(), but decoding the elements and fields of aggregates
+        //  through reflect, e.g. an adaptor wrapping this decoder.
+        template<typename Reflect, typename T>
+        bool delegate(Reflect& reflect, T& out) {
+            if (strict() and _depth == 0) {
+                return parse_document(reflect, out);
+            }
+            return parse_value(reflect, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool delegate(Reflect& reflect, substring key, T& out) {
+            return parse_property(reflect, key, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool delegate(Reflect& reflect, substring* key, T& out) {
+            return parse_property(reflect, key, out);
         }
 
     public: // parsing
 
+        //  Parses a complete document, which in strict mode must not be
+        //  followed by anything but whitespace.
+        template<typename T>
+        bool parse_document(T& out) {
+            return parse_document(*this, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_document(Reflect& reflect, T& out) {
+            const bool parsed = parse_value(reflect, out);
+            if (parsed and strict() and peek_token() != token::undefined) {
+                error("invalid character",offset(),1);
+            }
+            return parsed and not _error;
+        }
+
         template<typename T>
         bool parse_null(T& out) {
-            if (consume_null(no_consumer)) {
-                out = nullptr;
-                return true;
+            if (peek_token() == token::null) {
+                if (consume_null(no_consumer)) {
+                    out = nullptr;
+                    return true;
+                }
+                return false;
             }
-            if (peek_token() != token::undefined) {
+            if (peek_value()) {
                 error("expected null",offset());
             }
             return false;
@@ -64,15 +180,18 @@ namespace reflect::codecs::json {
 
         template<typename T>
         bool parse_boolean(T& out) {
-            if (consume_false(no_consumer)) {
-                out = false;
-                return true;
-            }
-            if (consume_true(no_consumer)) {
-                out = true;
-                return true;
+            if (peek_token() == token::boolean) {
+                if (peek('f') and consume_false(no_consumer)) {
+                    out = false;
+                    return true;
+                }
+                if (consume_true(no_consumer)) {
+                    out = true;
+                    return true;
+                }
+                return false;
             }
-            if (peek_token() != token::undefined) {
+            if (peek_value()) {
                 error("expected boolean",offset());
             }
             return false;
@@ -96,7 +215,7 @@ namespace reflect::codecs::json {
             if (consume_number(consumer)) {
                 return true;
             }
-            if (peek_token() != token::undefined) {
+            if (peek_value()) {
                 error("expected number",offset());
             }
             return false;
@@ -106,8 +225,8 @@ namespace reflect::codecs::json {
         bool parse_string(T& out) {
             auto consumer = [&](token t, size_t i, size_t n){
                 if (t == token::string) {
-                    const auto str = unescape_string(i,n);
-                    out = T(str);
+                    const auto str = view_string(i,n);
+                    out.assign(str.begin(),str.end());
                     return;
                 }
                 error("unexpected property",i,n);
@@ -115,7 +234,7 @@ namespace reflect::codecs::json {
             if (consume_string(consumer)) {
                 return true;
             }
-            if (peek_token() != token::undefined) {
+            if (peek_value()) {
                 error("expected string",offset());
             }
             return false;
@@ -123,35 +242,78 @@ namespace reflect::codecs::json {
 
         template<typename T>
         bool parse_property(substring key, T& out) {
+            return parse_property(*this, key, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_property(Reflect& reflect, substring key, T& out) {
             const auto start = offset();
             bool found = false;
             auto consumer = [&](token t, size_t i, size_t n){
                 if (t == token::property) {
                     const auto str = unescape_string(i,n);
+                    tally(&decoder_statistics::property_comparisons);
                     found = (key == str);
                 } else error("expected property",i,n);
             };
             while (consume_string(consumer) and not found) {
-                skip_value();
-            }
-            if (found) {
-                parse_value(out);
+                skip_property_value();
             }
+            const bool parsed = found and parse_value(reflect, out);
             seek(start);
+            return parsed and not _error;
+        }
+
+        //  Positions the decoder at the value of the named property of the
+        //  current object, skipping the properties preceding it.
+        bool seek_property(substring key) {
+            bool found = false;
+            auto consumer = [&](token t, size_t i, size_t n){
+                if (t == token::property) {
+                    const auto str = unescape_string(i,n);
+                    tally(&decoder_statistics::property_comparisons);
+                    found = (key == str);
+                } else error("expected property",i,n);
+            };
+            while (consume_string(consumer) and not found) {
+                skip_property_value();
+            }
+            return found;
+        }
+
+        //  Parses the next property key, leaving the decoder positioned at its
+        //  value.  The key refers to the input or to scratch storage, and is
+        //  valid until the decoder is next used.
+        bool parse_property(substring* key) {
+            auto consumer = [&](token t, size_t i, size_t n){
+                if (t == token::property) {
+                    *key = view_string(i,n);
+                } else error("expected property",i,n);
+            };
+            if (consume_string(consumer) and not _error) {
+                return true;
+            }
+            *key = nullptr;
             return false;
         }
 
         template<typename T>
         bool parse_property(substring* key, T& out) {
-            std::string property_key;
+            return parse_property(*this, key, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_property(Reflect& reflect, substring* key, T& out) {
+            size_t key_offset = 0, key_size = 0;
             auto consumer = [&](token t, size_t i, size_t n){
                 if (t == token::property) {
-                    const auto str = unescape_string(i,n);
-                    property_key = str;
+                    key_offset = i;
+                    key_size = n;
                 } else error("expected property",i,n);
             };
-            if (consume_string(consumer) and parse_value(out)) {
-                *key = _property_key = property_key;
+            if (consume_string(consumer) and not _error and
+                parse_value(reflect, out)) {
+                *key = view_string(key_offset,key_size);
                 return true;
             }
             *key = nullptr;
@@ -160,6 +322,20 @@ namespace reflect::codecs::json {
 
         template<typename T>
         bool parse_value(T& out) {
+            return parse_value(*this, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_value(Reflect& reflect, T& out) {
+            if constexpr(accepts_null<Reflect,T>::value) {
+                // e.g. json::patcher, to which null means removal
+                if (peek_token() == token::null) {
+                    return consume_null(no_consumer) and reflect.null(out);
+                }
+            }
+            if constexpr(is_null_v<T>) {
+                return parse_null(out);
+            }
             if constexpr(is_boolean_v<T>) {
                 return parse_boolean(out);
             }
@@ -170,51 +346,128 @@ namespace reflect::codecs::json {
                 return parse_string(out);
             }
             if constexpr(is_array_v<T>) {
-                return parse_array(out);
+                return parse_array(reflect, out);
             }
             if constexpr(is_object_v<T>) {
-                return parse_object(out);
+                return parse_object(reflect, out);
+            }
+        }
+
+        //  Estimates the number of elements remaining in the current array
+        //  or object by scanning ahead for separators without tokenizing,
+        //  so that containers can reserve capacity before decoding into
+        //  them.  Returns zero when the input is not contiguous in memory.
+        size_t size_hint() {
+            if (_error) return 0;
+            const substring s = _reader->view(offset(),size_t(-1));
+            const char* itr = s.begin();
+            const char* const end = s.end();
+            size_t count = 0;
+            size_t depth = 0;
+            bool element = false;
+            for (; itr < end; ++itr) {
+                switch (*itr) {
+                    case'"': {
+                        itr = scan_string(itr+1,end);
+                        if (not itr) return 0;
+                        itr -= 1;
+                        element = true;
+                    } break;
+                    case'[':
+                    case'{': {
+                        depth += 1;
+                        element = true;
+                    } break;
+                    case']':
+                    case'}': {
+                        if (depth == 0) return count + element;
+                        depth -= 1;
+                    } break;
+                    case',': {
+                        if (depth) break;
+                        count += element;
+                        element = false;
+                    } break;
+                    case' ':
+                    case'\t':
+                    case'\n':
+                    case'\r': break;
+                    default: element = true; break;
+                }
             }
+            return 0;
         }
 
         bool parse_array_head() {
-            return consume_array_head(no_consumer);
+            skip_whitespace();
+            if (consume_array_head(no_consumer)) {
+                _depth += 1;
+                return true;
+            }
+            return false;
         }
 
         bool parse_array_tail() {
-            while (peek_token() != token::array_tail and skip_value());
-            return consume_array_tail(no_consumer);
+            while (peek_token() != token::array_tail and skip_element());
+            if (consume_array_tail(no_consumer)) {
+                _depth -= 1;
+                return true;
+            }
+            return false;
         }
 
         template<typename T>
         bool parse_array(T& out) {
+            return parse_array(*this, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_array(Reflect& reflect, T& out) {
             if (parse_array_head()) {
-                decode<T>(*this,out);
+                decode<T>(reflect,out);
                 if (parse_array_tail()) {
                     return true;
                 }
                 error("expected ']'",offset());
+            } else if (strict() and peek_value()) {
+                error("expected '['",offset());
             }
             return false;
         }
 
         bool parse_object_head() {
-            return consume_object_head(no_consumer);
+            skip_whitespace();
+            if (consume_object_head(no_consumer)) {
+                _depth += 1;
+                return true;
+            }
+            return false;
         }
 
         bool parse_object_tail() {
-            while (peek_token() != token::object_tail and skip_value());
-            return consume_object_tail(no_consumer);
+            while (peek_token() != token::object_tail and skip_member());
+            if (consume_object_tail(no_consumer)) {
+                _depth -= 1;
+                return true;
+            }
+            return false;
         }
 
         template<typename T>
         bool parse_object(T& out) {
+            return parse_object(*this, out);
+        }
+
+        template<typename Reflect, typename T>
+        bool parse_object(Reflect& reflect, T& out) {
             if (parse_object_head()) {
-                decode<T>(*this,out);
+                decode<T>(reflect,out);
                 if (parse_object_tail()) {
                     return true;
                 }
                 error("expected '}'",offset());
+            } else if (strict() and peek_value()) {
+                error("expected '{'",offset());
             }
             return false;
         }
@@ -223,15 +476,19 @@ namespace reflect::codecs::json {
 
         static void no_consumer(token,size_t,size_t) {}
 
+        bool strict() const {
+            return _validation == validation::strict;
+        }
+
         template<typename Consumer>
         void consume(Consumer&& consumer, token t, size_t i) {
-            const size_t n = decoder::offset() - i;
+            const size_t n = basic_decoder::offset() - i;
             consume(consumer,t,i,n);
         }
 
         template<typename Consumer>
         void consume(Consumer&& consumer, token t, size_t i, size_t n) {
-            const auto start = decoder::offset();
+            const auto start = basic_decoder::offset();
             consumer(t,i,n);
             seek(start);
         }
@@ -242,10 +499,6 @@ namespace reflect::codecs::json {
             _error = read_error{*_reader, message, offset, size};
         }
 
-        size_t offset() const {
-            return _reader->offset();
-        }
-
         char peek() const {
             if (_error) return 0;
             return _reader->peek();
@@ -264,7 +517,7 @@ namespace reflect::codecs::json {
                     seek(start);
                     return false;
                 }
-                _reader->read();
+                read();
             }
             seek(start);
             return true;
@@ -278,11 +531,22 @@ namespace reflect::codecs::json {
 
         char read() {
             if (_error) return 0;
+            #if reflect_codecs_json_statistics
+            tally_read(offset(),1);
+            #endif
             return _reader->read();
         }
 
         void seek(size_t offset) {
             if (_error) return;
+            #if reflect_codecs_json_statistics
+            const auto start = this->offset();
+            if (offset < start) {
+                tally(&decoder_statistics::seeks);
+            } else {
+                tally_read(start,offset-start);
+            }
+            #endif
             return _reader->seek(offset);
         }
 
@@ -398,13 +662,18 @@ namespace reflect::codecs::json {
 
         bool skip_number_integer() {
             const auto start = offset();
+            const bool negative = skip('-');
+            const auto digits = offset();
+            const bool zero = peek('0');
             if (skip_number_digits()) {
+                // RFC 8259 forbids leading zeros, which strtoll ignores
+                if (zero and strict() and offset() - digits > 1) {
+                    error("leading zero",digits,offset()-digits);
+                    return false;
+                }
                 return true;
             }
-            if (skip('-')) {
-                if (skip_number_digits()) {
-                    return true;
-                }
+            if (negative) {
                 error("invalid integer",start,1);
                 return false;
             }
@@ -420,7 +689,7 @@ namespace reflect::codecs::json {
             if (skip('"')) {
                 char c;
                 while ((c = read()) != '"') {
-                    if (is_control(c)) {
+                    if (is_control(uint8_t(c))) {
                         error("invalid character",start);
                         return false;
                     }
@@ -461,24 +730,42 @@ namespace reflect::codecs::json {
         void unescape_string() {
             reflect_assert(_utf8.front()=='"');
             reflect_assert(_utf8.back()=='"');
-            _utf8.pop_back();
-            _utf8.erase(_utf8.begin());
-            for (size_t i = 0; i < _utf8.size(); ++i) {
-                const auto itr = _utf8.begin()+1;
-                if (*itr != '\\') continue;
-                _utf8.erase(itr);
-                switch (*(itr+1)) {
-                    case '"':
-                    case'\\':
-                    case '/': continue;
-                    case 'b': *itr='\b'; continue;
-                    case 'f': *itr='\f'; continue;
-                    case 'n': *itr='\n'; continue;
-                    case 'r': *itr='\r'; continue;
-                    case 't': *itr='\t'; continue;
-                    case 'u': continue; // TODO: utf16 to utf8
+            const char* itr = _utf8.data() + 1;
+            const char* const end = _utf8.data() + _utf8.size() - 1;
+            char* out = _utf8.data();
+            while (itr < end) {
+                const char c = *itr++;
+                if (c != '\\') {
+                    *out++ = c;
+                    continue;
+                }
+                switch (const char e = *itr++) {
+                    case 'b': *out++ = '\b'; continue;
+                    case 'f': *out++ = '\f'; continue;
+                    case 'n': *out++ = '\n'; continue;
+                    case 'r': *out++ = '\r'; continue;
+                    case 't': *out++ = '\t'; continue;
+                    case 'u': {
+                        char32_t u = hex_quad_to_int(itr);
+                        itr += 4;
+                        const bool is_pair = bool{
+                            (u >= 0xD800) and (u < 0xDC00) and
+                            (end - itr >= 6) and
+                            (itr[0] == '\\') and (itr[1] == 'u')
+                        };
+                        if (is_pair) {
+                            const char32_t l = hex_quad_to_int(itr + 2);
+                            if ((l >= 0xDC00) and (l < 0xE000)) {
+                                u = 0x10000 + ((u - 0xD800) << 10) + (l - 0xDC00);
+                                itr += 6;
+                            }
+                        }
+                        out = utf32_to_utf8(out,u);
+                    } continue;
+                    default: *out++ = e; continue; // '"', '\\', '/'
                 }
             }
+            _utf8.resize(size_t(out - _utf8.data()));
             _utf8.push_back(0);
             _utf8.pop_back();
         }
@@ -490,10 +777,37 @@ namespace reflect::codecs::json {
         }
 
         const char* read_string(size_t offset, size_t size) {
+            #if reflect_codecs_json_statistics
+            const auto capacity = _utf8.capacity();
+            tally(&decoder_statistics::bytes_reread,size);
+            #endif
             _reader->peek(_utf8,offset,size);
+            #if reflect_codecs_json_statistics
+            if (_utf8.capacity() != capacity) {
+                tally(&decoder_statistics::allocations);
+            }
+            #endif
             return _utf8.data();
         }
 
+        substring view_token(size_t offset, size_t size) {
+            const substring s = _reader->view(offset,size);
+            if (s.size() == size) {
+                return s;
+            }
+            read_string(offset,size);
+            return substring(_utf8.data(),_utf8.size());
+        }
+
+        substring view_string(size_t offset, size_t size) {
+            const substring s = _reader->view(offset,size);
+            if (s.size() == size and not memchr(s.data(),'\\',size)) {
+                return substring(s.data()+1,size-2);
+            }
+            unescape_string(offset,size);
+            return substring(_utf8.data(),_utf8.size());
+        }
+
         bool skip_string_hex_quad() {
             const auto start = offset();
             if (skip_while(is_hex) == 4) {
@@ -597,12 +911,117 @@ namespace reflect::codecs::json {
 
         // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-        bool skip_value() {
+        //  Skips an unwanted array element.
+        bool skip_element() {
+            tally(&decoder_statistics::skipped_values);
+            if (strict()) {
+                visitor visitor;
+                return visit_value(visitor);
+            }
+            return skip_value();
+        }
+
+        //  Skips an unwanted object member, a property and its value, counting
+        //  them as one skipped value.
+        bool skip_member() {
+            if (strict()) {
+                auto consumer = [&](token t, size_t i, size_t n){
+                    if (t != token::property)
+                        error("expected property",i,n);
+                };
+                if (consume_string(consumer)) {
+                    return skip_property_value();
+                }
+                error("expected property name",offset());
+                return false;
+            }
+            tally(&decoder_statistics::skipped_values);
+            bool property = false;
+            return skip_value(&property)
+               and (not property
+                    or peek_token() == token::object_tail
+                    or skip_value());
+        }
+
+        //  Skips the value of a property whose name has been consumed.
+        bool skip_property_value() {
+            tally(&decoder_statistics::skipped_values);
+            if (strict()) {
+                visitor visitor;
+                if (visit_value(visitor)) {
+                    return true;
+                }
+                error("expected value",offset());
+                return false;
+            }
+            return skip_value();
+        }
+
+        //  Skips the next value, or property name, without tokenizing it when
+        //  the input is contiguous.  The scanners below check the same grammar
+        //  as the tokenizer, but leave reporting malformed input, comments and
+        //  deeply nested values to skip_tokens(), which rescans them.  Sets
+        //  *property when what was skipped was a property name.
+        bool skip_value(bool* property = nullptr) {
+            skip_whitespace();
+            if (_error) return false;
+            const auto start = offset();
+            const substring s = _reader->view(start,size_t(-1));
+            const char* const head = s.begin();
+            const char* const end = s.end();
+            const char* itr = nullptr;
+            switch (s[0]) {
+                case 0 :
+                case']':
+                case'}': return skip_tokens(property);
+                case'"': itr = scan_valid_string(head+1,end); break;
+                case'[':
+                case'{': itr = scan_aggregate(head,end); break;
+                default: itr = scan_scalar(head,end); break;
+            }
+            if (not itr) {
+                return skip_tokens(property);
+            }
+            seek(start + size_t(itr - head));
+            if (s[0] == '"') {
+                skip_whitespace();
+                if (skip(':')) {
+                    skip_whitespace();
+                    if (property) *property = true;
+                    return true;
+                }
+            }
+            return skip_comma();
+        }
+
+        bool skip_tokens(bool* property = nullptr) {
             const auto start = offset();
             int depth = 0;
+            uint64_t objects = 0; // a bit per level, set for objects
+            std::vector<uint64_t> outer; // the bits of levels beyond 64
             auto consumer = [&](token t, size_t i, size_t n) {
-                depth += (t==token::array_head)|(t==token::object_head);
-                depth -= (t==token::array_tail)|(t==token::object_tail);
+                if (t == token::property and depth == 0 and property) {
+                    *property = true;
+                }
+                if (t == token::array_head or t == token::object_head) {
+                    if (depth > 0 and depth % 64 == 0) {
+                        outer.push_back(objects);
+                    }
+                    objects = (objects << 1) | (t == token::object_head);
+                    depth += 1;
+                }
+                if (t == token::array_tail or t == token::object_tail) {
+                    const bool object = (t == token::object_tail);
+                    if (depth > 0 and (objects & 1) != object) {
+                        error("mismatched bracket",i,1);
+                    }
+                    objects >>= 1;
+                    depth -= 1;
+                    if (depth > 0 and depth % 64 == 0) {
+                        objects = outer.back();
+                        outer.pop_back();
+                    }
+                }
             };
             if (consume_token(consumer)) {
                 while (depth > 0 and consume_token(consumer));
@@ -612,6 +1031,215 @@ namespace reflect::codecs::json {
             return false;
         }
 
+        //  Returns the end of the string whose opening quote precedes itr, or
+        //  nullptr if it is unterminated.
+        static const char* scan_string(const char* itr, const char* end) {
+            while (auto q = (const char*)memchr(itr,'"',size_t(end-itr))) {
+                const char* escapes = q;
+                while (escapes > itr and escapes[-1] == '\\') --escapes;
+                if ((q - escapes) % 2 == 0) return q + 1;
+                itr = q + 1;
+            }
+            return nullptr;
+        }
+
+        //  As scan_string(), but also returns nullptr if the string contains
+        //  a control character or an invalid escape sequence.
+        static const char* scan_valid_string(const char* itr, const char* end) {
+            // short strings, e.g. most keys, end before memchr() pays off
+            const char* const head = itr + std::min(end - itr,ptrdiff_t(16));
+            for (; itr < head; ++itr) {
+                const char c = *itr;
+                if (c == '"') return itr + 1;
+                if (c == '\\' or is_control(uint8_t(c))) break;
+            }
+            const char* quote = nullptr;
+            while (itr < end) {
+                if (quote < itr) {
+                    quote = (const char*)memchr(itr,'"',size_t(end-itr));
+                    if (not quote) return nullptr;
+                }
+                itr = skip_plain(itr,quote);
+                for (; itr < quote; itr = skip_plain(itr+1,quote)) {
+                    const char c = *itr;
+                    if (is_control(uint8_t(c))) return nullptr;
+                    if (c == '\\') {
+                        if (++itr == end) return nullptr;
+                        switch (*itr) {
+                            case '"':
+                            case'\\':
+                            case '/':
+                            case 'b':
+                            case 'f':
+                            case 'n':
+                            case 'r':
+                            case 't': break;
+                            case 'u': {
+                                if (end - itr < 5) return nullptr;
+                                for (int i = 1; i <= 4; ++i) {
+                                    if (not is_hex(itr[i])) return nullptr;
+                                }
+                                itr += 4;
+                            } break;
+                            default: return nullptr;
+                        }
+                    }
+                }
+                // unless an escape consumed it, the quote closes the string
+                if (itr == quote) return quote + 1;
+            }
+            return nullptr;
+        }
+
+        //  Returns the first byte in [itr,end) which is a backslash or, as
+        //  is_control() defines them, a control character, or a byte shortly
+        //  before it, testing eight bytes at a time.
+        static const char* skip_plain(const char* itr, const char* end) {
+            constexpr uint64_t ones = ~uint64_t(0) / 255;
+            constexpr uint64_t highs = ones * 0x80;
+            for (; end - itr >= 8; itr += 8) {
+                uint64_t word;
+                memcpy(&word,itr,8);
+                const uint64_t backslash = word ^ (ones * '\\');
+                const uint64_t del = word ^ (ones * 0x7F);
+                const uint64_t special = ((backslash - ones) & ~backslash)
+                                       | ((del - ones) & ~del)
+                                       | ((word - ones * 0x20) & ~word);
+                if (special & highs) break;
+            }
+            return itr;
+        }
+
+        //  Returns the end of the array or object beginning at itr, or nullptr
+        //  if it is unterminated, malformed, nested more than 64 deep, or
+        //  contains a comment.
+        static const char* scan_aggregate(const char* itr, const char* end) {
+            // the states which also accept a closing bracket are odd
+            enum { value, value_or_tail, name, name_or_tail, colon, comma };
+            uint64_t objects = 0; // a bit per level, set for objects
+            size_t depth = 0;
+            int expect = value;
+            while (itr < end) {
+                const char c = *itr;
+                if (is_space(c)) { ++itr; continue; }
+                switch (expect) {
+                    case value:
+                    case value_or_tail:
+                    case name:
+                    case name_or_tail: {
+                        const bool tail = (c == ']' or c == '}');
+                        if (tail and expect % 2) break; // closed below
+                        if (c == '"') {
+                            itr = scan_valid_string(itr+1,end);
+                            if (not itr) return nullptr;
+                            expect = (expect >= name) ? colon : comma;
+                            continue;
+                        }
+                        if (expect >= name) return nullptr;
+                        if (c == '[' or c == '{') {
+                            if (depth == 64) return nullptr;
+                            const bool object = (c == '{');
+                            objects = (objects << 1) | object;
+                            depth += 1;
+                            expect = object ? name_or_tail : value_or_tail;
+                            ++itr;
+                            continue;
+                        }
+                        itr = scan_scalar(itr,end);
+                        if (not itr) return nullptr;
+                        expect = comma;
+                        continue;
+                    }
+                    case colon: {
+                        if (c != ':') return nullptr;
+                        expect = value;
+                        ++itr;
+                        continue;
+                    }
+                    case comma: {
+                        if (c == ',') {
+                            const bool tail = Syntax::trailing_commas;
+                            if (objects & 1) {
+                                expect = tail ? name_or_tail : name;
+                            } else {
+                                expect = tail ? value_or_tail : value;
+                            }
+                            ++itr;
+                            continue;
+                        }
+                    } break;
+                }
+                // only a bracket matching the innermost aggregate may follow
+                if (c != ((objects & 1) ? '}' : ']')) return nullptr;
+                objects >>= 1;
+                ++itr;
+                if (--depth == 0) return itr;
+                expect = comma;
+            }
+            return nullptr;
+        }
+
+        //  Returns the end of the number or literal beginning at itr, or
+        //  nullptr if there is none, or it is followed by anything but
+        //  whitespace or punctuation.
+        static const char* scan_scalar(const char* itr, const char* end) {
+            const char* const head = itr;
+            switch (*itr) {
+                case 'n': itr = scan_literal(itr,end,"null"); break;
+                case 'f': itr = scan_literal(itr,end,"false"); break;
+                case 't': itr = scan_literal(itr,end,"true"); break;
+                default : itr = scan_number(itr,end); break;
+            }
+            if (not itr or itr == head) return nullptr;
+            if (itr == end) return itr;
+            switch (*itr) {
+                case' ':
+                case'\t':
+                case'\n':
+                case'\r':
+                case',':
+                case':':
+                case'/':
+                case']':
+                case'}': return itr;
+                default: return nullptr;
+            }
+        }
+
+        static const char* scan_literal(
+            const char* itr, const char* end, const char* literal)
+        {
+            for (; *literal; ++itr, ++literal) {
+                if (itr == end or *itr != *literal) return nullptr;
+            }
+            return itr;
+        }
+
+        //  Leading zeros are left to skip_tokens(), which rejects them in
+        //  strict mode and accepts them otherwise.
+        static const char* scan_number(const char* itr, const char* end) {
+            auto digits = [&]{
+                const char* const head = itr;
+                while (itr < end and is_digit(*itr)) ++itr;
+                return itr > head;
+            };
+            if (itr < end and *itr == '-') ++itr;
+            if (end - itr > 1 and itr[0] == '0' and is_digit(itr[1])) {
+                return nullptr;
+            }
+            if (not digits()) return nullptr;
+            if (itr < end and *itr == '.') {
+                ++itr;
+                if (not digits()) return nullptr;
+            }
+            if (itr < end and (*itr == 'e' or *itr == 'E')) {
+                ++itr;
+                if (itr < end and (*itr == '+' or *itr == '-')) ++itr;
+                if (not digits()) return nullptr;
+            }
+            return itr;
+        }
+
         token peek_token() {
             skip_whitespace();
             const char c = peek();
@@ -643,6 +1271,15 @@ namespace reflect::codecs::json {
             }
         }
 
+        bool peek_value() {
+            switch (peek_token()) {
+                case token::undefined:
+                case token::array_tail:
+                case token::object_tail: return false;
+                default: return true;
+            }
+        }
+
         template<typename Consumer>
         bool consume_token(Consumer&& consumer) {
             const auto start = offset();
@@ -684,6 +1321,12 @@ namespace reflect::codecs::json {
             skip_whitespace();
             if (skip(',')) {
                 skip_whitespace();
+                if constexpr(not Syntax::trailing_commas) {
+                    if (peek(']') or peek('}')) {
+                        error("trailing ','",offset());
+                        return false;
+                    }
+                }
                 return true;
             }
             switch(peek()) {
@@ -720,7 +1363,11 @@ namespace reflect::codecs::json {
         // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
         void skip_whitespace() {
-            while (skip_comment() or skip_while(is_space));
+            if constexpr(Syntax::comments) {
+                while (skip_comment() or skip_while(is_space));
+            } else {
+                skip_while(is_space);
+            }
         }
 
     private: // conversion
@@ -759,8 +1406,45 @@ namespace reflect::codecs::json {
             return _hex_to_int(u);
         };
 
+        static char16_t hex_quad_to_int(const char* s) {
+            return char16_t(
+                (hex_to_int(s[0]) << 12) |
+                (hex_to_int(s[1]) <<  8) |
+                (hex_to_int(s[2]) <<  4) |
+                (hex_to_int(s[3]) <<  0));
+        }
+
+        static char* utf32_to_utf8(char* out, char32_t u) {
+            if (u < 0x80) {
+                *out++ = char(u);
+            } else if (u < 0x800) {
+                *out++ = char(0xC0 | (u >> 6));
+                *out++ = char(0x80 | (u & 0x3F));
+            } else if (u < 0x10000) {
+                *out++ = char(0xE0 | (u >> 12));
+                *out++ = char(0x80 | ((u >> 6) & 0x3F));
+                *out++ = char(0x80 | (u & 0x3F));
+            } else {
+                *out++ = char(0xF0 | (u >> 18));
+                *out++ = char(0x80 | ((u >> 12) & 0x3F));
+                *out++ = char(0x80 | ((u >> 6) & 0x3F));
+                *out++ = char(0x80 | (u & 0x3F));
+            }
+            return out;
+        }
+
     private: // predicates
 
+        //  True when an adaptor decoding through this decoder handles null
+        //  values itself, by a member null(T&).
+        template<typename Reflect, typename T, typename = void>
+        struct accepts_null : std::false_type {};
+
+        template<typename Reflect, typename T>
+        struct accepts_null<Reflect,T,std::void_t<
+            decltype(std::declval<Reflect&>().null(std::declval<T&>()))
+        >> : std::true_type {};
+
         static int is_digit(const int c) {
             return ((c >= int('0'))&(c <= int('9')));
         }
@@ -780,6 +1464,28 @@ namespace reflect::codecs::json {
             return ((c == N)|(c == R)|(c == S)|(c == T));
         }
 
+    private: // statistics
+
+        void tally(
+            [[maybe_unused]] size_t decoder_statistics::* counter,
+            [[maybe_unused]] size_t n = 1) {
+            #if reflect_codecs_json_statistics
+            _statistics.*counter += n;
+            #endif
+        }
+
+        #if reflect_codecs_json_statistics
+        //  Counts n bytes consumed from offset, distinguishing bytes consumed
+        //  for the first time from those consumed again after a seek back.
+        void tally_read(size_t offset, size_t n) {
+            const size_t end = offset + n;
+            const size_t fresh = end - std::min(end,std::max(offset,_read_end));
+            _statistics.bytes_read += fresh;
+            _statistics.bytes_reread += n - fresh;
+            _read_end = std::max(end,_read_end);
+        }
+        #endif
+
     private: // utility
 
         template<typename T>
@@ -798,7 +1504,7 @@ namespace reflect::codecs::json {
 
         template<typename T, typename U>
         static T clamp(U in) {
-            const U min = U(std::numeric_limits<T>::min());
+            const U min = U(std::numeric_limits<T>::lowest());
             const U max = U(std::numeric_limits<T>::max());
             return clamp<T,U>(in,min,max);
         }
@@ -811,58 +1517,115 @@ namespace reflect::codecs::json {
     #define reflect_codecs_json_decoder_validate_debug 0
     #endif
 
-    inline read_error decoder::validate() {
+    #ifndef reflect_codecs_json_decoder_max_depth
+    #define reflect_codecs_json_decoder_max_depth 256
+    #endif
+
+    template<typename Syntax>
+    read_error basic_decoder<Syntax>::validate() {
+        visitor visitor;
+        return visit(visitor);
+    }
+
+    template<typename Syntax>
+    template<typename Visitor>
+    read_error basic_decoder<Syntax>::visit(Visitor& visitor) {
         const auto start = offset();
-        enum scope { root, array, object, property };
-        std::vector<scope> stack {root};
+        while (visit_value(visitor));
+        if (peek_token() != token::undefined) {
+            error("invalid character",offset(),1);
+        }
+        seek(start);
+        return error();
+    }
 
-        #if reflect_codecs_json_decoder_validate_debug
+    template<typename Syntax>
+    template<typename Visitor>
+    bool basic_decoder<Syntax>::visit_value(Visitor& visitor) {
+        switch (peek_token()) {
+            case token::undefined:
+            case token::array_tail:
+            case token::object_tail: return false;
+            default: break;
+        }
+        enum scope : char { root, array, object, property };
+        enum { max_depth = reflect_codecs_json_decoder_max_depth };
+        scope stack[max_depth * 2 + 1];
+        scope* top = stack;
+        *top = root;
+        // arrays and objects count towards max_depth, properties do not
         unsigned depth = 0;
-        #endif // reflect_codecs_json_decoder_validate_debug
 
         auto consumer = [&](token t, size_t i, size_t n){
-            const bool indent(stack.back() and stack.back()!=property);
+            #if reflect_codecs_json_decoder_validate_debug
+            const bool indent(*top and *top!=property);
+            #endif // reflect_codecs_json_decoder_validate_debug
             switch (t) {
                 case token::array_head: {
-                    if (stack.back() == object)
+                    if (*top == object)
                         return error("expected property",i);
-                    stack.push_back(array);
+                    if (depth == max_depth)
+                        return error("maximum depth exceeded",i);
+                    *++top = array;
+                    visitor.start_array();
                 } break;
                 case token::array_tail: {
-                    if (stack.back() != array)
+                    if (*top != array)
                         return error("invalid character",i,1);
-                    stack.pop_back();
-                    if (stack.back() == property)
-                        stack.pop_back();
+                    top -= 1;
+                    if (*top == property)
+                        top -= 1;
+                    visitor.end_array();
                 } break;
                 case token::object_head: {
-                    if (stack.back() == object)
+                    if (*top == object)
                         return error("expected property",i);
-                    stack.push_back(object);
+                    if (depth == max_depth)
+                        return error("maximum depth exceeded",i);
+                    *++top = object;
+                    visitor.start_object();
                 } break;
                 case token::object_tail: {
-                    if (stack.back() != object)
+                    if (*top != object)
                         return error("invalid character",i,1);
-                    stack.pop_back();
-                    if (stack.back() == property)
-                        stack.pop_back();
+                    top -= 1;
+                    if (*top == property)
+                        top -= 1;
+                    visitor.end_object();
                 } break;
                 case token::property: {
-                    if (stack.back() != object)
+                    if (*top != object)
                         return error("unexpected property",i,n);
-                    stack.push_back(property);
+                    *++top = property;
+                    visitor.key(view_string(i,n));
                 } break;
                 default: {
-                    if (stack.back() == object)
+                    if (*top == object)
                         return error("expected property name",i);
-                    if (stack.back() == property)
-                        stack.pop_back();
+                    if (*top == property)
+                        top -= 1;
+                    switch (t) {
+                        case token::null: {
+                            visitor.null();
+                        } break;
+                        case token::boolean: {
+                            visitor.boolean(n == 4);
+                        } break;
+                        case token::number: {
+                            visitor.number(view_token(i,n));
+                        } break;
+                        case token::string: {
+                            visitor.string(view_string(i,n));
+                        } break;
+                        default: break;
+                    }
                 } break;
             }
 
-            #if reflect_codecs_json_decoder_validate_debug
             depth += (t==token::array_head)|(t==token::object_head);
             depth -= (t==token::array_tail)|(t==token::object_tail);
+
+            #if reflect_codecs_json_decoder_validate_debug
             if (indent) {
                 for (auto i=0u; i < depth; ++i) std::cout << "    ";
             }
@@ -874,10 +1637,15 @@ namespace reflect::codecs::json {
             }
             #endif // reflect_codecs_json_decoder_validate_debug
         };
-        while (consume_token(consumer));
-        seek(start);
-        return error();
+        while (consume_token(consumer) and top != stack);
+        if (top != stack) {
+            error("unexpected end of input",offset());
+        }
+        return not _error;
     }
 
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    using decoder = basic_decoder<>;
 
 } // namespace reflect::codecs::json
@@ -0,0 +1,135 @@
+#pragma once
+#include <iterator>
+#include <type_traits>
+#include "decoder.hpp"
+
+namespace reflect::codecs::json {
+
+    //--------------------------------------------------------------------------
+    //  each<T>
+    //
+    //  An input range over the elements of a JSON array, decoding one element
+    //  at a time into a single instance of T, so that arbitrarily large arrays
+    //  can be processed without materializing a container.
+    //
+    //  The instance is reset before each element, so fields absent from an
+    //  element are default rather than left over from its predecessor.  A
+    //  T with a clear() method, e.g. a container, is cleared to keep its
+    //  capacity; any other T is assigned a default constructed T.
+    //
+    //  The range begins at the current position of the decoder, so a nested
+    //  array can be visited by first positioning the decoder on it, e.g. with
+    //  parse_object_head() and seek_property().
+    //
+    //  EXAMPLE:
+    //
+    //      reflect::stream_reader reader(file);
+    //      for (auto& record : json::each<record_t>(reader)) {
+    //          process(record);
+    //      }
+    //
+    template<typename T, typename Decoder = decoder>
+    class each {
+
+        Decoder _owned;
+
+        Decoder& _decoder;
+
+        T _value {};
+
+    public: // types
+
+        class iterator;
+
+    public: // structors
+
+        explicit each(reader& reader)
+        :_owned(reader)
+        ,_decoder(_owned) {}
+
+        explicit each(Decoder& decoder)
+        :_decoder(decoder) {}
+
+        each(const each&) = delete;
+        each& operator = (const each&) = delete;
+
+    public: // properties
+
+        read_error error() const { return _decoder.error(); }
+
+    public: // iterators
+
+        iterator begin() {
+            if (_decoder.parse_array_head() and next()) {
+                return iterator(this);
+            }
+            return end();
+        }
+
+        iterator end() { return iterator(); }
+
+    private: // decoding
+
+        bool next() {
+            if constexpr(has_clear<T>::value) {
+                _value.clear();
+            } else {
+                _value = T{};
+            }
+            if (_decoder(_value)) {
+                return true;
+            }
+            _decoder.parse_array_tail();
+            return false;
+        }
+
+    private: // predicates
+
+        template<typename U, typename = void>
+        struct has_clear : std::false_type {};
+
+        template<typename U>
+        struct has_clear<U,std::void_t<
+            decltype(std::declval<U&>().clear())
+        >> : std::true_type {};
+
+    };
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    template<typename T, typename Decoder>
+    class each<T,Decoder>::iterator {
+        each* _each = nullptr;
+
+        friend class each;
+
+        explicit iterator(each* e):_each(e) {}
+
+    public: // types
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+
+    public: // structors
+
+        iterator() = default;
+
+    public: // operators
+
+        T& operator *() const { return _each->_value; }
+
+        T* operator ->() const { return &_each->_value; }
+
+        iterator& operator ++() {
+            if (not _each->next()) _each = nullptr;
+            return *this;
+        }
+
+        bool operator ==(const iterator& i) const { return _each == i._each; }
+        bool operator !=(const iterator& i) const { return _each != i._each; }
+    };
+
+} // namespace reflect::codecs::json
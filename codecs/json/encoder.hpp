@@ -1,14 +1,18 @@
 #pragma once
+#include <cstring>
 #include <sstream>
+#include <utility>
 #include "preferences.hpp"
+#include "statistics.hpp"
 #include "../../assert.hpp"
+#include "../../cached.hpp"
 #include "../../writer.hpp"
 
 namespace reflect::codecs::json {
 
     class encoder {
 
-        writer* const _writer = writer::null;
+        writer* _writer = writer::null;
 
         enum scope { root, array, object, property } _scope = root;
 
@@ -16,7 +20,15 @@ namespace reflect::codecs::json {
 
         unsigned _scope_size = 0;
 
-        const preferences _prefs;
+        preferences _prefs;
+
+        bool _measuring = false;
+
+        const std::shared_ptr<fragment_cache>* _enclosing = nullptr;
+
+        #if reflect_codecs_json_statistics
+        encoder_statistics _statistics;
+        #endif
 
     public: // structors
 
@@ -26,68 +38,227 @@ namespace reflect::codecs::json {
         :_writer(&writer)
         ,_prefs(prefs) {}
 
+        //  Encoding into a counting_writer only measures the output, skipping
+        //  the formatting of integers and strings.
+        encoder(counting_writer& writer, preferences prefs={})
+        :_writer(&writer)
+        ,_prefs(prefs)
+        ,_measuring(true) {}
+
+    public: // session
+
+        //  Rebinds the encoder to a new writer, ready to encode the next
+        //  message.
+        void reset(writer& writer) {
+            _writer = &writer;
+            _measuring = false;
+            reset();
+        }
+
+        void reset(counting_writer& writer) {
+            _writer = &writer;
+            _measuring = true;
+            reset();
+        }
+
+        void reset(writer& writer, preferences prefs) {
+            _prefs = prefs;
+            reset(writer);
+        }
+
+        void reset(counting_writer& writer, preferences prefs) {
+            _prefs = prefs;
+            reset(writer);
+        }
+
+        void reset() {
+            _scope = root;
+            _scope_depth = 0;
+            _scope_size = 0;
+            _enclosing = nullptr;
+        }
+
+    public: // properties
+
+        size_t offset() const { return _writer->offset(); }
+
+        const encoder_statistics& statistics() const {
+            #if reflect_codecs_json_statistics
+            return _statistics;
+            #else
+            static const encoder_statistics none;
+            return none;
+            #endif
+        }
+
     public: // encoding
 
         template<typename T>
         void operator()(const T& in) {
-            return write_value(in);
+            return delegate(*this, in);
         }
 
         template<typename T>
         void operator()(substring key, const T& in) {
-            return write_property(key, in);
+            return delegate(*this, key, in);
+        }
+
+        template<typename T>
+        void operator()(const field_name& key, const T& in) {
+            return delegate(*this, key, in);
+        }
+
+    public: // delegation
+
+        //  As operator(), but encoding the elements and fields of aggregates
+        //  through reflect, e.g. an adaptor wrapping this encoder.
+        template<typename Reflect, typename T>
+        void delegate(Reflect& reflect, const T& in) {
+            return write_value(reflect, in);
+        }
+
+        template<typename Reflect, typename T>
+        void delegate(Reflect& reflect, substring key, const T& in) {
+            return write_property(reflect, key, in);
+        }
+
+        template<typename Reflect, typename T>
+        void delegate(Reflect& reflect, const field_name& key, const T& in) {
+            return write_property(reflect, key, in);
         }
 
     private: // writing
 
+        void write(char c) {
+            #if reflect_codecs_json_statistics
+            _statistics.writes += 1;
+            _statistics.bytes_written += 1;
+            #endif
+            _writer->write(c);
+        }
+
+        void write(substring s) {
+            #if reflect_codecs_json_statistics
+            _statistics.writes += 1;
+            _statistics.bytes_written += s.size();
+            #endif
+            _writer->write(s);
+        }
+
+        void write_borrowed(substring s) {
+            #if reflect_codecs_json_statistics
+            _statistics.writes += 1;
+            _statistics.bytes_written += s.size();
+            #endif
+            _writer->write_borrowed(s);
+        }
+
+        //  Accounts for n bytes without writing them, when measuring.
+        void write_measured(size_t n) {
+            #if reflect_codecs_json_statistics
+            _statistics.writes += 1;
+            _statistics.bytes_written += n;
+            #endif
+            _writer->write(nullptr,n);
+        }
+
         void write_null() {
-            _writer->write("null");
+            write("null");
         }
 
         template<typename T>
         void write_boolean(const T& in) {
-            _writer->write(bool(in)?"true":"false");
+            write(bool(in)?"true":"false");
         }
 
         template<typename T>
         void write_number(const T& in) {
+            if constexpr(is_formatted_integer<T>::value) {
+                if (_measuring) {
+                    return write_measured(count_digits(in));
+                }
+            }
             enum { size = 32 };
             char buffer[32] {0};
-            _writer->write(format_number(buffer,in));
+            write(format_number(buffer,in));
         }
 
+        //  Writes runs of characters which need no escaping in one call.
         template<typename T>
         void write_string(const T& in) {
-            _writer->write('\"');
-            for (const char c : in) {
-                if (auto escaped = escape(c)) {
-                    _writer->write(escaped);
-                } else {
-                    _writer->write(c);
+            const char* run = in.data();
+            const char* const end = run + in.size();
+            if (_measuring) {
+                size_t size = in.size() + 2;
+                for (const char* itr = run; itr < end; ++itr) {
+                    if (auto escaped = escape(*itr)) {
+                        size += strlen(escaped) - 1;
+                    }
+                }
+                return write_measured(size);
+            }
+            const bool borrow = _prefs.borrow_strings and is_string_v<T>;
+            auto write_run = [&](const char* head, const char* tail) {
+                const substring run(head,size_t(tail-head));
+                if (borrow) write_borrowed(run); else write(run);
+            };
+            write('\"');
+            for (const char* itr = run; itr < end; ++itr) {
+                if (auto escaped = escape(*itr)) {
+                    if (itr > run) {
+                        write_run(run,itr);
+                    }
+                    write(escaped);
+                    run = itr + 1;
                 }
             }
-            _writer->write('\"');
+            if (end > run) {
+                write_run(run,end);
+            }
+            write('\"');
         }
 
-        template<typename T>
-        void write_property(substring key, const T& in) {
-            reflect_assert(_scope == object);
-            write_separator();
+        void write_key(substring key) {
             write_string(key);
             write_colon();
+        }
+
+        //  Writes the precomputed "name": in one call when the colon is the
+        //  default, otherwise "name" followed by the colon.
+        void write_key(const field_name& key) {
+            const auto colon = _prefs.colon;
+            if (colon and colon[0] == ':' and colon[1] == 0) {
+                write(key.quoted());
+            } else {
+                write(key.quoted().truncate(1));
+                write_colon();
+            }
+        }
+
+        template<typename Reflect, typename Key, typename T>
+        void write_property(Reflect& reflect, const Key& key, const T& in) {
+            reflect_assert(_scope == object);
+            write_separator();
+            write_key(key);
             const auto previous_scope = _scope;
             const auto previous_scope_size = _scope_size;
             _scope = property;
             _scope_size = 0;
-            write_value(in);
+            write_value(reflect, in);
             _scope = previous_scope;
             _scope_size = previous_scope_size;
         }
 
-        template<typename T>
-        void write_value(const T& in) {
+        template<typename Reflect, typename T>
+        void write_value(Reflect& reflect, const T& in) {
             reflect_assert(_scope != object);
             write_separator();
+            if constexpr(is_cached_v<T>) {
+                return write_cached(reflect, in);
+            }
+            if constexpr(is_null_v<T>) {
+                return write_null();
+            }
             if constexpr(is_boolean_v<T>) {
                 return write_boolean(in);
             }
@@ -98,32 +269,89 @@ namespace reflect::codecs::json {
                 return write_string(in);
             }
             if constexpr(is_array_v<T>) {
-                return write_array(in);
+                return write_array(reflect, in);
             }
             if constexpr(is_object_v<T>) {
-                return write_object(in);
+                return write_object(reflect, in);
             }
         }
 
-        template<typename T>
-        void write_array(const T& in) {
-            write_aggregate<array,'[',']'>(in);
+        //  Writes the bytes cached for the value if they were encoded in the
+        //  same context, otherwise encodes the value into a new fragment and
+        //  publishes it.  Published bytes are lent to the writer, see
+        //  cached<T>.  Should another thread publish a fragment of another
+        //  context first, the new bytes are copied to the writer instead.
+        template<typename Reflect, typename T>
+        void write_cached(Reflect& reflect, const cached<T>& in) {
+            const auto cache = in.cache();
+            if (_enclosing) {
+                cache->link(*_enclosing);
+            }
+            const uint64_t context = cache_context();
+            auto current = cache->load();
+            if (current and current->context == context) {
+                return write_borrowed(substring(
+                    current->bytes.data(),current->bytes.size()));
+            }
+            auto encoded = std::make_shared<fragment_cache::fragment>();
+            encoded->context = context;
+            if (current) {
+                encoded->bytes.reserve(current->bytes.size());
+            }
+            vector_writer<> fragment(encoded->bytes);
+            const auto previous_writer = std::exchange(_writer,&fragment);
+            const auto previous_enclosing = std::exchange(_enclosing,&cache);
+            const auto previous_scope = std::exchange(_scope,property);
+            const auto previous_measuring = std::exchange(_measuring,false);
+            write_value(reflect, in.value());
+            _measuring = previous_measuring;
+            _scope = previous_scope;
+            _enclosing = previous_enclosing;
+            _writer = previous_writer;
+            const substring bytes(encoded->bytes.data(),encoded->bytes.size());
+            current = cache->publish(std::move(current),encoded);
+            if (current and current->context == context) {
+                return write_borrowed(substring(
+                    current->bytes.data(),current->bytes.size()));
+            }
+            write(bytes);
         }
 
-        template<typename T>
-        void write_object(const T& in) {
-            write_aggregate<object,'{','}'>(in);
+        //  Identifies the preferences and depth which the bytes encoded for
+        //  a cached value depend on.
+        uint64_t cache_context() const {
+            uint64_t context = hash64("json",4,_scope_depth);
+            for (const char* s : {
+                _prefs.colon,_prefs.comma,_prefs.indent,_prefs.newline
+            }) {
+                context = hash64(s,s?strlen(s):0,context);
+            }
+            const uint64_t flags
+                = uint64_t(_prefs.trailing_comma)
+                | uint64_t(_prefs.newline_at_eof) << 1
+                | uint64_t(_prefs.float_format) << 2;
+            return hash64(&flags,sizeof(flags),context);
+        }
+
+        template<typename Reflect, typename T>
+        void write_array(Reflect& reflect, const T& in) {
+            write_aggregate<array,'[',']'>(reflect, in);
+        }
+
+        template<typename Reflect, typename T>
+        void write_object(Reflect& reflect, const T& in) {
+            write_aggregate<object,'{','}'>(reflect, in);
         }
 
-        template<scope Scope, char Head, char Tail, typename T>
-        void write_aggregate(const T& in) {
+        template<scope Scope, char Head, char Tail, typename Reflect, typename T>
+        void write_aggregate(Reflect& reflect, const T& in) {
             const auto previous_scope = _scope;
             const auto previous_scope_size = _scope_size;
             _scope = Scope;
             _scope_size = 0;
-            _writer->write(Head);
+            write(Head);
             _scope_depth += 1;
-            encode<T>(*this,in);
+            encode<T>(reflect,in);
             _scope_depth -= 1;
             if (_scope_size) {
                 if (_prefs.trailing_comma) {
@@ -132,7 +360,7 @@ namespace reflect::codecs::json {
                 write_newline();
                 write_indent();
             }
-            _writer->write(Tail);
+            write(Tail);
             _scope = previous_scope;
             _scope_size = previous_scope_size;
             if (_scope_depth == 0 and _prefs.newline_at_eof) {
@@ -145,14 +373,14 @@ namespace reflect::codecs::json {
         void write_colon() {
             const auto colon = _prefs.colon;
             if (colon and colon[0]) {
-                _writer->write(colon);
+                write(colon);
             }
         }
 
         void write_comma() {
             const auto comma = _prefs.comma;
             if (comma and comma[0]) {
-                _writer->write(comma);
+                write(comma);
             }
         }
 
@@ -160,14 +388,14 @@ namespace reflect::codecs::json {
             const auto indent = _prefs.indent;
             if (indent and indent[0]) {
                 auto d = _scope_depth;
-                while (d-->0) _writer->write(indent);
+                while (d-->0) write(indent);
             }
         }
 
         void write_newline() {
             const auto newline = _prefs.newline;
             if (newline and newline[0]) {
-                _writer->write(newline);
+                write(newline);
             }
         }
 
@@ -246,6 +474,23 @@ namespace reflect::codecs::json {
             return buffer;
         }
 
+        template<typename T>
+        static size_t count_digits(T in) {
+            using U = std::make_unsigned_t<T>;
+            size_t n = 1;
+            U u = U(in);
+            if constexpr(std::is_signed_v<T>) {
+                if (in < 0) {
+                    n += 1;
+                    u = U(0) - u;
+                }
+            }
+            for (; u >= 10; u /= 10) {
+                n += 1;
+            }
+            return n;
+        }
+
         static const char* escape(const char c) {
             switch (c) {
                 case'\x00': return R"(\u0000)";
@@ -289,10 +534,44 @@ namespace reflect::codecs::json {
 
     private: // predicates
 
+        //  The integers which format_number() formats.
+        template<typename T>
+        struct is_formatted_integer : std::bool_constant<
+            std::is_same_v<T,unsigned short> or
+            std::is_same_v<T,unsigned int> or
+            std::is_same_v<T,unsigned long> or
+            std::is_same_v<T,unsigned long long> or
+            std::is_same_v<T,signed short> or
+            std::is_same_v<T,signed int> or
+            std::is_same_v<T,signed long> or
+            std::is_same_v<T,signed long long>
+        > {};
+
         static int is_control(const int c) {
             return ((c <= 0x1F)|(c == 0x7F));
         }
 
     };
 
+    //--------------------------------------------------------------------------
+
+    //  Returns the exact size of the JSON encoding of value with the given
+    //  preferences, without formatting it where avoidable, e.g. to allocate
+    //  a buffer_writer.
+    //
+    //  EXAMPLE:
+    //
+    //      std::vector<char> frame(encoded_size(prefs,message));
+    //      reflect::buffer_writer writer(frame.data(),frame.size());
+    //      json::encoder encoder(writer,prefs);
+    //      encoder(message);
+    //
+    template<typename T>
+    size_t encoded_size(const preferences& prefs, const T& value) {
+        counting_writer writer;
+        encoder encoder(writer,prefs);
+        encoder(value);
+        return writer.offset();
+    }
+
 } // namespace reflect::codecs::json
@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "decoder.hpp"
+#include "encoder.hpp"
+#include "../../delta.hpp"
+
+namespace reflect::codecs::json {
+
+    //--------------------------------------------------------------------------
+    //  patcher<Decoder>
+    //
+    //  Wraps a decoder to apply a JSON merge patch (RFC 7386) onto an existing
+    //  value in place.  Fields and map entries absent from the patch are left
+    //  as they are, objects are patched recursively, arrays are replaced
+    //  whole, and null removes a map entry or resets a field to its default.
+    //
+    template<typename Decoder = decoder>
+    class patcher {
+
+        Decoder& _decoder;
+
+        //  Map entries nulled by the patch, erased once their map is done:
+        //  the address of the value, and the end of the key in _removed_keys.
+        struct removal {
+            const void* value;
+            size_t key_end;
+        };
+
+        std::vector<removal> _removed;
+
+        std::string _removed_keys;
+
+        std::string _key;
+
+        bool _entry = false;
+
+        bool _null = false;
+
+    public: // structors
+
+        explicit patcher(Decoder& decoder)
+        :_decoder(decoder) {}
+
+    public: // properties
+
+        Decoder& decoder() const { return _decoder; }
+
+    public: // decoding
+
+        template<typename T>
+        bool operator()(T& out) {
+            // the value of a map entry follows its key
+            const bool entry = std::exchange(_entry,false);
+            return patch(out,entry,[&](auto& out){
+                return _decoder.delegate(*this,out);
+            });
+        }
+
+        template<typename T>
+        bool operator()(substring key, T& out) {
+            _entry = false;
+            return patch(out,false,[&](auto& out){
+                return _decoder.delegate(*this,key,out);
+            });
+        }
+
+        bool operator()(substring* key) {
+            _entry = _decoder(key);
+            if (_entry) {
+                _key.assign(key->begin(),key->size());
+            }
+            return _entry;
+        }
+
+        size_t size_hint() {
+            return _decoder.size_hint();
+        }
+
+        //  Called by the decoder for a null value.
+        template<typename T>
+        bool null(T&) {
+            _null = true;
+            return true;
+        }
+
+    private: // patching
+
+        template<typename T, typename Parse>
+        bool patch(T& out, bool entry, Parse&& parse) {
+            bool parsed = false;
+            if constexpr(is_array_v<T>) {
+                T replacement = make_replacement(out);
+                parsed = parse(replacement);
+                if (parsed and not _null) {
+                    out = std::move(replacement);
+                }
+            } else if constexpr(is_map<T>::value) {
+                const size_t removed = _removed.size();
+                parsed = parse(out);
+                erase(out,removed);
+            } else {
+                parsed = parse(out);
+            }
+            if (std::exchange(_null,false) and parsed) {
+                if (entry) {
+                    _removed_keys += _key;
+                    _removed.push_back({&out,_removed_keys.size()});
+                } else {
+                    out = T();
+                }
+            }
+            return parsed;
+        }
+
+        //  Erases the entries of map removed since the given count, looking
+        //  up string keys, and otherwise the values' addresses in one pass.
+        template<typename T>
+        void erase(T& map, size_t removed) {
+            if (_removed.size() == removed) return;
+            const auto first = _removed.begin() + removed;
+            const size_t keys = removed ? first[-1].key_end : 0;
+            using key_type = typename T::key_type;
+            if constexpr(is_string_v<key_type>) {
+                size_t head = keys;
+                for (auto r = first; r != _removed.end(); ++r) {
+                    const std::string_view key(
+                        _removed_keys.data()+head,r->key_end-head);
+                    head = r->key_end;
+                    if constexpr(has_transparent_lookup_v<T>) {
+                        const auto itr = map.find(key);
+                        if (itr != map.end()) {
+                            map.erase(itr);
+                        }
+                    } else {
+                        map.erase(key_type(
+                            key.data(),key.size(),map.get_allocator()));
+                    }
+                }
+            } else {
+                auto by_value = [](const removal& a, const removal& b){
+                    return std::less<const void*>()(a.value,b.value);
+                };
+                std::sort(first,_removed.end(),by_value);
+                for (auto itr = map.begin(); itr != map.end();) {
+                    const removal r {&itr->second,0};
+                    if (std::binary_search(first,_removed.end(),r,by_value)) {
+                        itr = map.erase(itr);
+                    } else {
+                        ++itr;
+                    }
+                }
+            }
+            _removed.erase(first,_removed.end());
+            _removed_keys.resize(keys);
+        }
+
+        template<typename T>
+        static T make_replacement(const T& out) {
+            if constexpr(has_allocator<T>::value) {
+                return make_using_allocator<T>(out.get_allocator());
+            } else {
+                return T();
+            }
+        }
+
+    private: // predicates
+
+        template<typename T, typename = void>
+        struct is_map : std::false_type {};
+
+        template<typename T>
+        struct is_map<T,std::void_t<typename T::mapped_type>>
+        : std::true_type {};
+
+        template<typename T, typename = void>
+        struct has_allocator : std::false_type {};
+
+        template<typename T>
+        struct has_allocator<T,std::void_t<
+            decltype(std::declval<const T&>().get_allocator())
+        >> : std::true_type {};
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Encodes the merge patch which transforms baseline into current.  An
+    //  unchanged value is encoded as {}.
+    //
+    //  EXAMPLE:
+    //
+    //      json::encode_delta(encoder,previous,state);
+    //      previous = state;
+    //
+    template<typename T>
+    void encode_delta(encoder& encoder, const T& baseline, const T& current) {
+        encoder(delta<T>(baseline,current));
+    }
+
+    //  Decodes a merge patch, applying it onto target in place.  Returns
+    //  false if the input is not an object or the decoder reports an error.
+    //
+    //  EXAMPLE:
+    //
+    //      json::decoder decoder(reader);
+    //      if (not json::apply_patch(decoder,replica)) {
+    //          request_full_state();
+    //      }
+    //
+    template<typename Decoder, typename T>
+    bool apply_patch(Decoder& decoder, T& target) {
+        patcher<Decoder> patcher(decoder);
+        return patcher(target) and not decoder.error();
+    }
+
+} // namespace reflect::codecs::json
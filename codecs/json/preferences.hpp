@@ -11,7 +11,13 @@ namespace reflect::codecs::json {
         const char* newline = "";
         bool trailing_comma = false;
         bool newline_at_eof = false;
-        float_format float_format = float_format::concise;
+        json::float_format float_format = json::float_format::concise;
+
+        //  Lends the characters of string values to writers which can write
+        //  them by reference, see writer::write_borrowed().  Only enable when
+        //  reflections pass strings that outlive the writer's next flush,
+        //  i.e. members rather than temporaries.
+        bool borrow_strings = false;
 
         preferences(
             const char* colon = ":",
@@ -20,14 +26,16 @@ namespace reflect::codecs::json {
             const char* newline = "",
             bool trailing_comma = false,
             bool newline_at_eof = false,
-            enum float_format float_format = float_format::concise)
+            enum float_format float_format = float_format::concise,
+            bool borrow_strings = false)
         :colon(colon)
         ,comma(comma)
         ,indent(indent)
         ,newline(newline)
         ,trailing_comma(trailing_comma)
         ,newline_at_eof(newline_at_eof)
-        ,float_format(float_format) {}
+        ,float_format(float_format)
+        ,borrow_strings(borrow_strings) {}
     };
 
 } // namespace reflect::codecs::json
@@ -0,0 +1,445 @@
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include "decoder.hpp"
+
+namespace reflect::codecs::json {
+
+    //--------------------------------------------------------------------------
+
+    //  Which values push_decoder decodes into its target.
+    enum class framing : char {
+        values,   // top-level values separated by whitespace, e.g. NDJSON
+        elements, // the elements of top-level arrays, one at a time
+    };
+
+    //--------------------------------------------------------------------------
+    //  push_decoder<T,Decoder>
+    //
+    //  Decodes a sequence of JSON values arriving in arbitrary chunks, e.g.
+    //  from a socket.  Each call to feed() scans the new bytes with a small
+    //  resumable state machine that may suspend anywhere, including in the
+    //  middle of a string, escape, number or comment.  Only the bytes of the
+    //  value in progress are retained; once a complete top-level value has
+    //  been scanned it is decoded into the target and released.
+    //
+    //  With framing::elements, the elements of top-level arrays are decoded
+    //  into the target one at a time as each completes, so a message holding
+    //  one large array, e.g. a bulk export, is never buffered whole; only the
+    //  separators of the array itself are checked by the scanner.
+    //
+    //  Decoding itself is not resumable: a value or element is decoded in one
+    //  pass once its last byte has arrived, so the target does not change
+    //  while one is arriving, and a single large object is buffered whole.
+    //
+    //  The bytes retained for a single value or element never exceed the
+    //  capacity given at construction; a larger one is reported as an error
+    //  as soon as its first capacity bytes have been fed.
+    //
+    //  Comments are only recognized between values when the Decoder's syntax
+    //  accepts them; otherwise they are left for the decoder to reject.
+    //
+    //  EXAMPLE:
+    //
+    //      message m;
+    //      json::push_decoder<message> decode(m);
+    //      ssize_t n;
+    //      while ((n = recv(fd,buffer,sizeof(buffer),0)) > 0) {
+    //          decode.feed(buffer,size_t(n),[](message& m){ dispatch(m); });
+    //      }
+    //      decode.finish([](message& m){ dispatch(m); });
+    //
+    //  or, for the records of one large array:
+    //
+    //      record r;
+    //      json::push_decoder<record> decode(r,64 << 10,json::framing::elements);
+    //
+    template<typename T, typename Decoder = decoder>
+    class push_decoder {
+
+        enum class scan : char {
+            space,
+            scalar,
+            aggregate,
+            string,
+            escape,
+            slash,
+            comment_line,
+            comment_block,
+            comment_block_star,
+        };
+
+        //  The separator expected next within a top-level array.
+        enum class expect : char {
+            first,   // an element or ']'
+            element, // an element, or ']' with trailing commas
+            comma,   // ',' or ']'
+        };
+
+        T& _out;
+
+        const size_t _capacity;
+
+        const framing _framing;
+
+        std::vector<char> _buffer;
+
+        std::optional<string_reader> _reader;
+
+        Decoder _decoder;
+
+        read_error _error;
+
+        size_t _scanned = 0;
+
+        size_t _start = 0;
+
+        unsigned _depth = 0;
+
+        scan _scan = scan::space;
+
+        scan _resume = scan::space;
+
+        bool _in_array = false;
+
+        expect _expect = expect::first;
+
+    public: // structors
+
+        explicit push_decoder(
+            T& out,
+            size_t capacity = 1 << 20,
+            framing framing = framing::values)
+        :_out(out)
+        ,_capacity(capacity)
+        ,_framing(framing) {}
+
+    public: // properties
+
+        read_error error() const { return _error; }
+
+        size_t buffered() const { return _buffer.size(); }
+
+        size_t capacity() const { return _capacity; }
+
+    public: // decoding
+
+        //  Scans the next chunk of input, decoding each value completed by it
+        //  into the target and passing the target to consumer.  Returns the
+        //  number of values decoded.
+        template<typename Consumer>
+        size_t feed(const char* s, size_t n, Consumer&& consumer) {
+            size_t count = 0;
+            while (n and not _error) {
+                // room for a whole value and the byte delimiting it
+                const size_t room = _capacity + 1 - _buffer.size();
+                const size_t size = std::min(n,room);
+                _buffer.insert(_buffer.end(),s,s+size);
+                s += size;
+                n -= size;
+                while (_scanned < _buffer.size() and not _error) {
+                    const size_t end = scan_value();
+                    if (end and decode_value(end,consumer)) {
+                        count += 1;
+                    }
+                }
+                if (_error) return count;
+                compact();
+                if (_buffer.size() > _capacity) {
+                    exceeds_capacity();
+                }
+            }
+            return count;
+        }
+
+        size_t feed(const char* s, size_t n) {
+            return feed(s,n,no_consumer);
+        }
+
+        //  Signals the end of input, decoding a trailing top-level number or
+        //  literal which can only be delimited by the end of input.  Returns
+        //  the number of values decoded.
+        template<typename Consumer>
+        size_t finish(Consumer&& consumer) {
+            if (_error) return 0;
+            size_t count = 0;
+            switch (_scan) {
+                case scan::space: break;
+                case scan::scalar: {
+                    if (decode_value(_buffer.size(),consumer)) {
+                        count += 1;
+                    }
+                } break;
+                case scan::comment_line: {
+                    if (_resume == scan::space) break;
+                } [[fallthrough]];
+                default: {
+                    _reader.emplace(substring(_buffer.data(),_buffer.size()));
+                    const size_t size = _buffer.size() - _start;
+                    _error = read_error{
+                        *_reader,"unexpected end of input",_start,size};
+                    return count;
+                }
+            }
+            if (_in_array) {
+                fail("unexpected end of input",_start);
+                return count;
+            }
+            reset();
+            return count;
+        }
+
+        size_t finish() {
+            return finish(no_consumer);
+        }
+
+        //  Discards any partially scanned value and clears the error state.
+        void reset() {
+            _buffer.clear();
+            _decoder.reset(*reader::null);
+            _reader.reset();
+            _error = {};
+            _scanned = _start = 0;
+            _depth = 0;
+            _scan = _resume = scan::space;
+            _in_array = false;
+            _expect = expect::first;
+        }
+
+    private: // scanning
+
+        static constexpr bool comments = Decoder::syntax_type::comments;
+
+        static constexpr bool trailing_commas =
+            Decoder::syntax_type::trailing_commas;
+
+        static void no_consumer(T&) {}
+
+        //  Advances the scanner until a complete top-level value is found,
+        //  returning its end offset, or until the buffer is exhausted,
+        //  returning zero.
+        size_t scan_value() {
+            const char* const data = _buffer.data();
+            const size_t size = _buffer.size();
+            for (size_t i = _scanned; i < size; ++i) {
+                const char c = data[i];
+                switch (_scan) {
+                    case scan::space: {
+                        if (is_space(c)) {
+                            _start = i + 1;
+                            continue;
+                        }
+                        if (c == '/' and comments) {
+                            enter_slash(scan::space);
+                            continue;
+                        }
+                        if (_framing == framing::elements and not frame(c,i)) {
+                            if (_error) return 0;
+                            _start = i + 1;
+                            continue;
+                        }
+                        if (c == ',') {
+                            fail("unexpected ','",i);
+                            return 0;
+                        }
+                        switch (c) {
+                            case '"': _scan = scan::string; continue;
+                            case '[':
+                            case '{': _depth = 1;
+                                      _scan = scan::aggregate; continue;
+                        }
+                        _scan = scan::scalar;
+                        continue;
+                    }
+                    case scan::scalar: {
+                        if (is_scalar(c)) continue;
+                        _scanned = i;
+                        _scan = scan::space;
+                        return i;
+                    }
+                    case scan::aggregate: {
+                        switch (c) {
+                            case '/': if (not comments) continue;
+                                      enter_slash(scan::aggregate); continue;
+                            case '"': _scan = scan::string; continue;
+                            case '[':
+                            case '{': _depth += 1; continue;
+                            case ']':
+                            case '}': {
+                                if (--_depth) continue;
+                                _scanned = i + 1;
+                                _scan = scan::space;
+                                return i + 1;
+                            }
+                            default: continue;
+                        }
+                    }
+                    case scan::string: {
+                        if (c == '\\') {
+                            _scan = scan::escape;
+                            continue;
+                        }
+                        if (c != '"') continue;
+                        if (_depth) {
+                            _scan = scan::aggregate;
+                            continue;
+                        }
+                        _scanned = i + 1;
+                        _scan = scan::space;
+                        return i + 1;
+                    }
+                    case scan::escape: {
+                        _scan = scan::string;
+                        continue;
+                    }
+                    case scan::slash: {
+                        switch (c) {
+                            case '/': _scan = scan::comment_line; continue;
+                            case '*': _scan = scan::comment_block; continue;
+                        }
+                        // not a comment, let the decoder report it
+                        _scan = (_resume == scan::space)
+                              ? scan::scalar
+                              : _resume;
+                        i -= 1;
+                        continue;
+                    }
+                    case scan::comment_line: {
+                        if (c == '\n') leave_comment(i);
+                        continue;
+                    }
+                    case scan::comment_block: {
+                        if (c == '*') _scan = scan::comment_block_star;
+                        continue;
+                    }
+                    case scan::comment_block_star: {
+                        if (c == '/') leave_comment(i);
+                        else if (c != '*') _scan = scan::comment_block;
+                        continue;
+                    }
+                }
+            }
+            _scanned = size;
+            return 0;
+        }
+
+        //  Checks the brackets and separators of a top-level array, returning
+        //  true if c begins an element, false if c was consumed, or false with
+        //  an error.
+        bool frame(const char c, const size_t i) {
+            if (not _in_array) {
+                if (c != '[') {
+                    fail("expected array",i);
+                    return false;
+                }
+                _in_array = true;
+                _expect = expect::first;
+                return false;
+            }
+            switch (c) {
+                case ',': {
+                    if (_expect != expect::comma) {
+                        fail("unexpected ','",i);
+                        return false;
+                    }
+                    _expect = expect::element;
+                    return false;
+                }
+                case ']': {
+                    if (_expect == expect::element and not trailing_commas) {
+                        fail("trailing ','",i);
+                        return false;
+                    }
+                    _in_array = false;
+                    return false;
+                }
+            }
+            if (_expect == expect::comma) {
+                fail("missing ','",i);
+                return false;
+            }
+            _expect = expect::comma;
+            return true;
+        }
+
+        void enter_slash(scan resume) {
+            _resume = resume;
+            _scan = scan::slash;
+        }
+
+        void leave_comment(size_t i) {
+            _scan = _resume;
+            if (_scan == scan::space) {
+                _start = i + 1;
+            }
+        }
+
+        template<typename Consumer>
+        bool decode_value(size_t end, Consumer& consumer) {
+            const size_t start = _start;
+            if (end - start > _capacity) {
+                exceeds_capacity();
+                return false;
+            }
+            _start = end;
+            _reader.emplace(substring(_buffer.data()+start,end-start));
+            _decoder.reset(*_reader);
+            const bool decoded = _decoder(_out);
+            if ((_error = _decoder.error())) {
+                return false;
+            }
+            if (not decoded) {
+                _error = read_error{*_reader,"unexpected value",0,end-start};
+                return false;
+            }
+            consumer(_out);
+            return true;
+        }
+
+        void exceeds_capacity() {
+            fail("value exceeds capacity",_start);
+        }
+
+        void fail(const char* message, size_t offset) {
+            _reader.emplace(substring(_buffer.data(),_buffer.size()));
+            _error = read_error{*_reader,message,offset,0};
+        }
+
+        //  Releases the bytes of values already decoded.
+        void compact() {
+            _decoder.reset(*reader::null);
+            _reader.reset();
+            if (_start == 0) return;
+            _buffer.erase(_buffer.begin(),_buffer.begin()+_start);
+            _scanned -= _start;
+            _start = 0;
+        }
+
+    private: // predicates
+
+        static bool is_space(const char c) {
+            return c == ' ' or c == '\t' or c == '\n' or c == '\r';
+        }
+
+        static bool is_scalar(const char c) {
+            switch (c) {
+                case ' ' :
+                case '\t':
+                case '\n':
+                case '\r':
+                case ',' :
+                case ':' :
+                case '"' :
+                case '/' :
+                case '[' :
+                case ']' :
+                case '{' :
+                case '}' : return false;
+                default  : return c != 0;
+            }
+        }
+
+    };
+
+} // namespace reflect::codecs::json
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "decoder.hpp"
+#include "encoder.hpp"
+
+namespace reflect::codecs::json {
+
+    //--------------------------------------------------------------------------
+    //  session
+    //
+    //  A decoder, an encoder and scratch buffers for handling one message at
+    //  a time, e.g. a request and its response, kept in a reflect::pool so
+    //  that their capacity carries over from one message to the next.
+    //
+    //  EXAMPLE:
+    //
+    //      static reflect::pool<json::session> sessions;
+    //
+    //      auto session = sessions.acquire();
+    //      reflect::string_reader reader(body);
+    //      session->decoder.reset(reader);
+    //      session->decoder(request);
+    //      reflect::vector_writer writer(session->buffer);
+    //      session->encoder.reset(writer);
+    //      session->encoder(response);
+    //      send(session->buffer.data(),session->buffer.size());
+    //
+    struct session {
+
+        ::reflect::codecs::json::decoder decoder;
+
+        ::reflect::codecs::json::encoder encoder;
+
+        std::vector<char> buffer;   // e.g. the encoded response
+
+        std::string text;           // e.g. the message being decoded
+
+        //  Readies the session for the next message, keeping capacity.
+        void reset() {
+            decoder.reset();
+            encoder.reset();
+            buffer.clear();
+            text.clear();
+        }
+
+        //  The bytes reserved by the session's buffers.
+        size_t capacity() const {
+            return decoder.capacity() + buffer.capacity() + text.capacity();
+        }
+
+    };
+
+} // namespace reflect::codecs::json
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+//  reflect_codecs_json_statistics
+//
+//  When defined to 1, json::decoder and json::encoder count the work they do
+//  while decoding and encoding, e.g. to export to a metrics system and catch
+//  pathological payloads.  When 0, the default, nothing is counted and the
+//  statistics() accessors return zeros.
+//
+#ifndef reflect_codecs_json_statistics
+#define reflect_codecs_json_statistics 0
+#endif
+
+namespace reflect::codecs::json {
+
+    //  Counters accumulate over the lifetime of a decoder, including across
+    //  reset(), so that a pooled decoder can be sampled periodically.
+    struct decoder_statistics {
+        size_t bytes_read = 0;           // distinct bytes consumed
+        size_t bytes_reread = 0;         // bytes consumed again after a seek
+        size_t seeks = 0;                // seeks backward in the input
+        size_t property_comparisons = 0; // keys compared to a field name
+        size_t skipped_values = 0;       // values skipped without decoding
+        size_t allocations = 0;          // growths of the scratch buffer
+    };
+
+    struct encoder_statistics {
+        size_t writes = 0;               // calls to writer::write()
+        size_t bytes_written = 0;        // bytes passed to writer::write()
+    };
+
+} // namespace reflect::codecs::json
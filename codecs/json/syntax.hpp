@@ -0,0 +1,21 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+//  Compile-time JSON dialects, selecting the grammar accepted by
+//  basic_decoder<Syntax> without any runtime checks in its hot loops.
+
+namespace reflect::codecs::json::syntax {
+
+    // JSON extended with /* block */ and // line comments, and trailing commas
+    struct lenient {
+        static constexpr bool comments = true;
+        static constexpr bool trailing_commas = true;
+    };
+
+    // JSON as specified by RFC 8259
+    struct rfc8259 {
+        static constexpr bool comments = false;
+        static constexpr bool trailing_commas = false;
+    };
+
+} // namespace reflect::codecs::json::syntax
@@ -0,0 +1,40 @@
+#pragma once
+#include "../../substring.hpp"
+
+namespace reflect::codecs::json {
+
+    //--------------------------------------------------------------------------
+    //  visitor
+    //
+    //  Receives the events produced by decoder::visit().  Strings and keys are
+    //  unescaped, and numbers are passed as their source text.  Substrings
+    //  refer directly to the input when the reader is contiguous and the text
+    //  needs no unescaping, otherwise to a scratch buffer owned by the
+    //  decoder; either way they are only valid for the duration of the call.
+    //
+    //  Derive from visitor and hide the events of interest, the remainder
+    //  default to doing nothing.
+    //
+    //  EXAMPLE:
+    //
+    //      struct sum : json::visitor {
+    //          double total = 0;
+    //          void number(substring s) { total += strtod(s.data(),nullptr); }
+    //      };
+    //
+    //      sum v;
+    //      json::decoder(reader).visit(v);
+    //
+    struct visitor {
+        void start_object() {}
+        void end_object() {}
+        void start_array() {}
+        void end_array() {}
+        void key(substring) {}
+        void null() {}
+        void boolean(bool) {}
+        void number(substring) {}
+        void string(substring) {}
+    };
+
+} // namespace reflect::codecs::json
@@ -0,0 +1,340 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "assert.hpp"
+#include "reflect.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  member_pairs<T,F>
+    //
+    //  An encoder which, given the members of the object a as reflected for
+    //  encoding, calls f(key,a_member,b_member) with the member of b at the
+    //  same offset.  Members reflected without a key are passed their index.
+    //  As for decoding, the reflection must refer to members of the value
+    //  rather than to temporaries.
+    //
+    template<typename T, typename F>
+    class member_pairs {
+
+        const char* const _a;
+
+        const char* const _b;
+
+        F& _f;
+
+        size_t _index = 0;
+
+    public: // structors
+
+        member_pairs(const T& a, const T& b, F& f)
+        :_a(reinterpret_cast<const char*>(&a))
+        ,_b(reinterpret_cast<const char*>(&b))
+        ,_f(f) {}
+
+    public: // encoding
+
+        template<typename U>
+        void operator()(const U& in) {
+            pair(_index++,in);
+        }
+
+        template<typename U>
+        void operator()(substring key, const U& in) {
+            pair(key,in);
+        }
+
+        template<typename U>
+        void operator()(const field_name& key, const U& in) {
+            pair(key,in);
+        }
+
+    private: // pairing
+
+        template<typename Key, typename U>
+        void pair(const Key& key, const U& in) {
+            const char* const member = reinterpret_cast<const char*>(&in);
+            reflect_assert(member >= _a and member + sizeof(U) <= _a + sizeof(T));
+            _f(key,in,*reinterpret_cast<const U*>(_b + (member - _a)));
+        }
+
+    };
+
+    template<typename T, typename F>
+    void for_each_member_pair(const T& a, const T& b, F&& f) {
+        member_pairs<T,std::remove_reference_t<F>> pairs(a,b,f);
+        encode<T>(pairs,a);
+    }
+
+    //--------------------------------------------------------------------------
+    //  comparator
+    //
+    //  Compares two values of a reflected type structurally, recursing into
+    //  the fields of objects, the elements of arrays and the entries of maps.
+    //  Without a list of paths it stops at the first difference; with one it
+    //  visits everything, appending the JSON Pointer (RFC 6901) of each value
+    //  that changed, e.g. "/items/3/name".  Arrays which differ in size, and
+    //  map entries present on one side only, are reported as a whole.
+    //
+    //  Trivially copyable values are first compared with memcmp.  Identical
+    //  bytes are equal, so an unchanged NaN is not reported as changed, while
+    //  differing bytes are only conclusive when the type has unique object
+    //  representations and every byte belongs to a reflected value, e.g. ints
+    //  and structs of ints without padding or unreflected members.
+    //
+    //  The fields of types reflected by reflect_type() are paired by their
+    //  offset in the value, see member_pairs.
+    //
+    class comparator {
+
+        std::vector<std::string>* _paths = nullptr;
+
+        std::string _path;
+
+    public: // structors
+
+        comparator() = default;
+
+        explicit comparator(std::vector<std::string>& paths)
+        :_paths(&paths) {}
+
+    public: // comparison
+
+        //  Returns true if a and b are equal.
+        template<typename T>
+        bool operator()(const T& a, const T& b) {
+            if constexpr(std::is_trivially_copyable_v<T>) {
+                if (memcmp(&a,&b,sizeof(T)) == 0) {
+                    return true;
+                }
+                if constexpr(std::has_unique_object_representations_v<T>
+                    and is_fully_reflected<T>())
+                {
+                    if (not _paths) return false;
+                }
+            }
+            if constexpr(is_terminal_v<T>) {
+                return a == b or changed();
+            } else if constexpr(is_array_v<T>) {
+                return compare_array(a,b);
+            } else if constexpr(is_map<T>::value) {
+                return compare_map(a,b);
+            } else if constexpr(has_fields_v<T>) {
+                return compare_fields(a,b);
+            } else {
+                return compare_members(a,b);
+            }
+        }
+
+    private: // aggregates
+
+        template<typename T>
+        bool compare_array(const T& a, const T& b) {
+            if (a.size() != b.size()) {
+                return changed();
+            }
+            if constexpr(is_contiguous_bytes<T>::value) {
+                const size_t size = a.size() * sizeof(*a.data());
+                if (size == 0 or memcmp(a.data(),b.data(),size) == 0) {
+                    return true;
+                }
+                using element = std::remove_cv_t<std::remove_pointer_t<
+                    decltype(a.data())>>;
+                if constexpr(is_fully_reflected<element>()) {
+                    if (not _paths) return false;
+                }
+            }
+            bool equal = true;
+            size_t index = 0;
+            auto itr = b.begin();
+            for (const auto& element : a) {
+                equal = compare_nested(index++,element,*itr++) and equal;
+                if (not equal and not _paths) break;
+            }
+            return equal;
+        }
+
+        template<typename T>
+        bool compare_map(const T& a, const T& b) {
+            if (a.size() != b.size() and not _paths) {
+                return false;
+            }
+            bool equal = true;
+            for (const auto& entry : a) {
+                const auto itr = b.find(entry.first);
+                if (itr == b.end()) {
+                    equal = missing(entry.first);
+                } else {
+                    equal = compare_nested(
+                        entry.first,entry.second,itr->second) and equal;
+                }
+                if (not equal and not _paths) return false;
+            }
+            if (a.size() == b.size() and equal) {
+                // every key of a was found in b
+                return true;
+            }
+            for (const auto& entry : b) {
+                if (a.find(entry.first) == a.end()) {
+                    equal = missing(entry.first);
+                }
+            }
+            return equal;
+        }
+
+        template<typename T>
+        bool compare_fields(const T& a, const T& b) {
+            bool equal = true;
+            auto compare = [&](const auto& d) {
+                equal = compare_nested(d.name,d(a),d(b)) and equal;
+                return equal or _paths;
+            };
+            std::apply([&](const auto&... d){
+                (void)(compare(d) and ...);
+            },fields<T>::value);
+            return equal;
+        }
+
+        template<typename T>
+        bool compare_members(const T& a, const T& b) {
+            bool equal = true;
+            for_each_member_pair(a,b,[&](const auto& key, const auto& x, const auto& y){
+                if (equal or _paths) {
+                    equal = compare_nested(key,x,y) and equal;
+                }
+            });
+            return equal;
+        }
+
+    private: // paths
+
+        template<typename Key, typename T>
+        bool compare_nested(const Key& key, const T& a, const T& b) {
+            if (not _paths) return (*this)(a,b);
+            const size_t length = _path.size();
+            append(key);
+            const bool equal = (*this)(a,b);
+            _path.resize(length);
+            return equal;
+        }
+
+        template<typename Key>
+        bool missing(const Key& key) {
+            if (not _paths) return false;
+            const size_t length = _path.size();
+            append(key);
+            changed();
+            _path.resize(length);
+            return false;
+        }
+
+        bool changed() {
+            if (_paths) _paths->push_back(_path);
+            return false;
+        }
+
+        //  Appends a reference token, escaping '~' and '/'.
+        template<typename Key>
+        void append(const Key& key) {
+            _path += '/';
+            if constexpr(std::is_integral_v<Key>
+                and not is_boolean_v<Key> and not is_character_v<Key>)
+            {
+                char digits[24];
+                const auto result = std::to_chars(
+                    digits,digits+sizeof(digits),key);
+                _path.append(digits,result.ptr);
+            } else if constexpr(std::is_convertible_v<const Key&,std::string_view>) {
+                escape(key);
+            } else if constexpr(std::is_convertible_v<const Key&,substring>) {
+                const substring token = key;
+                escape(std::string_view(token.begin(),token.size()));
+            } else {
+                std::ostringstream token;
+                token << key;
+                escape(token.str());
+            }
+        }
+
+        void escape(std::string_view token) {
+            for (const char c : token) {
+                switch (c) {
+                    case '~': _path += "~0"; break;
+                    case '/': _path += "~1"; break;
+                    default : _path += c;
+                }
+            }
+        }
+
+    private: // predicates
+
+        //  True if the bytes of T are covered by the reflected values, e.g. a
+        //  number, or a struct whose fields' sizes add up to its own.
+        template<typename T>
+        static constexpr bool is_fully_reflected() {
+            if constexpr(is_terminal_v<T>) {
+                return true;
+            } else if constexpr(has_fields_v<T>) {
+                return covers<T>(fields<T>::value);
+            } else {
+                return false;
+            }
+        }
+
+        template<typename T, typename... Fields>
+        static constexpr bool covers(const std::tuple<Fields...>&) {
+            return (0 + ... + sizeof(typename Fields::value_type)) == sizeof(T)
+                and (is_fully_reflected<typename Fields::value_type>() and ...);
+        }
+
+        template<typename T, typename = void>
+        struct is_map : std::false_type {};
+
+        template<typename T>
+        struct is_map<T,std::void_t<typename T::mapped_type>>
+        : std::true_type {};
+
+        template<typename T, typename = void>
+        struct is_contiguous_bytes : std::false_type {};
+
+        template<typename T>
+        struct is_contiguous_bytes<T,std::void_t<
+            decltype(std::declval<const T&>().data())
+        >> : std::has_unique_object_representations<std::remove_cv_t<
+            std::remove_pointer_t<decltype(std::declval<const T&>().data())>
+        >> {};
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Returns true if the reflected values a and b are structurally equal.
+    template<typename T>
+    bool equal(const T& a, const T& b) {
+        return comparator()(a,b);
+    }
+
+    //  Returns the JSON Pointers of the values which differ between a and b,
+    //  in the order they are reflected.
+    //
+    //  EXAMPLE:
+    //
+    //      for (auto& path : reflect::diff(before,after)) {
+    //          log("changed: %s",path.c_str());
+    //      }
+    //
+    template<typename T>
+    std::vector<std::string> diff(const T& a, const T& b) {
+        std::vector<std::string> paths;
+        comparator comparator(paths);
+        comparator(a,b);
+        return paths;
+    }
+
+} // namespace reflect
@@ -0,0 +1,738 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "assert.hpp"
+#include "interface.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+
+//  Each compression format is available when its library's header is found,
+//  unless disabled by defining its macro as 0.  Programs using a format must
+//  link its library, e.g. -lz, -lzstd or -llz4.
+
+#ifndef reflect_compression_zlib
+#if __has_include(<zlib.h>)
+#define reflect_compression_zlib 1
+#else
+#define reflect_compression_zlib 0
+#endif
+#endif
+
+#ifndef reflect_compression_zstd
+#if __has_include(<zstd.h>)
+#define reflect_compression_zstd 1
+#else
+#define reflect_compression_zstd 0
+#endif
+#endif
+
+#ifndef reflect_compression_lz4
+#if __has_include(<lz4frame.h>)
+#define reflect_compression_lz4 1
+#else
+#define reflect_compression_lz4 0
+#endif
+#endif
+
+#if reflect_compression_zlib
+#include <zlib.h>
+#endif
+
+#if reflect_compression_zstd
+#include <zstd.h>
+#endif
+
+#if reflect_compression_lz4
+#include <lz4frame.h>
+#endif
+
+namespace reflect::compression {
+
+    //--------------------------------------------------------------------------
+    //  formats
+    //
+    //  A format provides a compressor, which compresses into a writer, and a
+    //  decompressor, which decompresses between buffers, both streaming and
+    //  reporting errors as messages.  Compressors checksum their content so
+    //  that corruption is detected, and decompressors accept concatenated
+    //  streams, so that compressed output may be appended to.
+    //
+    //      struct format {
+    //          static constexpr int default_level;
+    //          class compressor {
+    //              explicit compressor(int level);
+    //              const char* compress(const char*, size_t, writer&, flush);
+    //          };
+    //          class decompressor {
+    //              const char* decompress(
+    //                  const char*& in, const char* in_end,
+    //                  char*& out, char* out_end);
+    //              bool finished() const; // at the end of a stream
+    //              void reset();
+    //          };
+    //      };
+    //
+    enum class flush {
+        none,   // compress the input, possibly buffering output
+        block,  // also write everything compressed so far
+        end,    // also end the stream
+    };
+
+    //--------------------------------------------------------------------------
+
+    #if reflect_compression_zlib
+
+    //  The zlib (RFC 1950) format, or the gzip (RFC 1952) format when
+    //  WindowBits includes 16.  Either decompresses both.
+    template<int WindowBits>
+    struct basic_zlib {
+
+        static constexpr int default_level = Z_DEFAULT_COMPRESSION;
+
+        class compressor : interface {
+            z_stream _z {};
+            std::vector<char> _out;
+            const char* _error = nullptr;
+
+        public: // structors
+
+            explicit compressor(int level = default_level)
+            :_out(64 << 10) {
+                if (deflateInit2(&_z,level,Z_DEFLATED,WindowBits,8,
+                                 Z_DEFAULT_STRATEGY) != Z_OK) {
+                    _error = "zlib: deflateInit2 failed";
+                }
+            }
+
+            ~compressor() { if (not _error) deflateEnd(&_z); }
+
+        public: // compression
+
+            const char* compress(const char* s, size_t n, writer& out, flush f) {
+                if (_error) return _error;
+                const int mode = f == flush::end   ? Z_FINISH
+                               : f == flush::block ? Z_SYNC_FLUSH
+                               : Z_NO_FLUSH;
+                _z.next_in = (Bytef*)s;
+                _z.avail_in = uInt(n);
+                for (;;) {
+                    _z.next_out = (Bytef*)_out.data();
+                    _z.avail_out = uInt(_out.size());
+                    const int result = deflate(&_z,mode);
+                    if (result == Z_STREAM_ERROR) {
+                        return "zlib: invalid deflate state";
+                    }
+                    out.write(_out.data(),_out.size()-_z.avail_out);
+                    if (mode == Z_FINISH) {
+                        if (result != Z_STREAM_END) continue;
+                        deflateReset(&_z);
+                        return nullptr;
+                    }
+                    if (_z.avail_out != 0) return nullptr;
+                }
+            }
+
+        };
+
+        class decompressor : interface {
+            z_stream _z {};
+            const char* _error = nullptr;
+            bool _finished = true;
+
+        public: // structors
+
+            decompressor() {
+                // 32 detects the zlib or gzip header
+                if (inflateInit2(&_z,32+15) != Z_OK) {
+                    _error = "zlib: inflateInit2 failed";
+                }
+            }
+
+            ~decompressor() { if (not _error) inflateEnd(&_z); }
+
+        public: // decompression
+
+            const char* decompress(
+                const char*& in, const char* in_end,
+                char*& out, char* out_end)
+            {
+                if (_error) return _error;
+                _z.next_in = (Bytef*)in;
+                _z.avail_in = uInt(in_end - in);
+                _z.next_out = (Bytef*)out;
+                _z.avail_out = uInt(out_end - out);
+                const int result = inflate(&_z,Z_NO_FLUSH);
+                const bool progress = (const char*)_z.next_in != in;
+                in = (const char*)_z.next_in;
+                out = (char*)_z.next_out;
+                switch (result) {
+                    case Z_STREAM_END:
+                        _finished = true;
+                        inflateReset(&_z);
+                        return nullptr;
+                    case Z_OK:
+                    case Z_BUF_ERROR:
+                        _finished = _finished and not progress;
+                        return nullptr;
+                    default:
+                        return _z.msg ? _z.msg : "zlib: invalid stream";
+                }
+            }
+
+            bool finished() const { return _finished; }
+
+            void reset() {
+                if (not _error) inflateReset(&_z);
+                _finished = true;
+            }
+
+        };
+
+    };
+
+    using zlib = basic_zlib<15>;
+
+    using gzip = basic_zlib<15+16>;
+
+    #endif // reflect_compression_zlib
+
+    //--------------------------------------------------------------------------
+
+    #if reflect_compression_zstd
+
+    //  The Zstandard (RFC 8878) format.
+    struct zstd {
+
+        static constexpr int default_level = 3;
+
+        class compressor : interface {
+            ZSTD_CCtx* const _ctx = ZSTD_createCCtx();
+            std::vector<char> _out;
+
+        public: // structors
+
+            explicit compressor(int level = default_level)
+            :_out(ZSTD_CStreamOutSize()) {
+                if (_ctx) {
+                    ZSTD_CCtx_setParameter(_ctx,ZSTD_c_compressionLevel,level);
+                    ZSTD_CCtx_setParameter(_ctx,ZSTD_c_checksumFlag,1);
+                }
+            }
+
+            ~compressor() { ZSTD_freeCCtx(_ctx); }
+
+        public: // compression
+
+            const char* compress(const char* s, size_t n, writer& out, flush f) {
+                if (not _ctx) return "zstd: ZSTD_createCCtx failed";
+                const ZSTD_EndDirective mode = f == flush::end   ? ZSTD_e_end
+                                             : f == flush::block ? ZSTD_e_flush
+                                             : ZSTD_e_continue;
+                ZSTD_inBuffer input { s, n, 0 };
+                for (;;) {
+                    ZSTD_outBuffer output { _out.data(), _out.size(), 0 };
+                    const size_t result =
+                        ZSTD_compressStream2(_ctx,&output,&input,mode);
+                    if (ZSTD_isError(result)) {
+                        return ZSTD_getErrorName(result);
+                    }
+                    out.write(_out.data(),output.pos);
+                    const bool done = mode == ZSTD_e_continue
+                                    ? input.pos == input.size
+                                    : result == 0;
+                    if (done) return nullptr;
+                }
+            }
+
+        };
+
+        class decompressor : interface {
+            ZSTD_DCtx* const _ctx = ZSTD_createDCtx();
+            bool _finished = true;
+
+        public: // structors
+
+            decompressor() = default;
+
+            ~decompressor() { ZSTD_freeDCtx(_ctx); }
+
+        public: // decompression
+
+            const char* decompress(
+                const char*& in, const char* in_end,
+                char*& out, char* out_end)
+            {
+                if (not _ctx) return "zstd: ZSTD_createDCtx failed";
+                ZSTD_inBuffer input { in, size_t(in_end - in), 0 };
+                ZSTD_outBuffer output { out, size_t(out_end - out), 0 };
+                const size_t result = ZSTD_decompressStream(_ctx,&output,&input);
+                if (ZSTD_isError(result)) {
+                    return ZSTD_getErrorName(result);
+                }
+                if (input.pos or output.pos) {
+                    _finished = result == 0;
+                }
+                in += input.pos;
+                out += output.pos;
+                return nullptr;
+            }
+
+            bool finished() const { return _finished; }
+
+            void reset() {
+                if (_ctx) ZSTD_DCtx_reset(_ctx,ZSTD_reset_session_only);
+                _finished = true;
+            }
+
+        };
+
+    };
+
+    #endif // reflect_compression_zstd
+
+    //--------------------------------------------------------------------------
+
+    #if reflect_compression_lz4
+
+    //  The LZ4 frame format.
+    struct lz4 {
+
+        static constexpr int default_level = 0;
+
+        class compressor : interface {
+            enum : size_t { chunk = 64 << 10 };
+            LZ4F_cctx* _ctx = nullptr;
+            LZ4F_preferences_t _prefs {};
+            std::vector<char> _out;
+            bool _begun = false;
+
+        public: // structors
+
+            explicit compressor(int level = default_level) {
+                _prefs.compressionLevel = level;
+                _prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                _out.resize(LZ4F_compressBound(chunk,&_prefs));
+                if (LZ4F_isError(LZ4F_createCompressionContext(&_ctx,LZ4F_VERSION))) {
+                    _ctx = nullptr;
+                }
+            }
+
+            ~compressor() { LZ4F_freeCompressionContext(_ctx); }
+
+        public: // compression
+
+            const char* compress(const char* s, size_t n, writer& out, flush f) {
+                if (not _ctx) return "lz4: LZ4F_createCompressionContext failed";
+                if (not _begun) {
+                    const size_t size =
+                        LZ4F_compressBegin(_ctx,_out.data(),_out.size(),&_prefs);
+                    if (LZ4F_isError(size)) return LZ4F_getErrorName(size);
+                    out.write(_out.data(),size);
+                    _begun = true;
+                }
+                while (n) {
+                    const size_t count = std::min<size_t>(n,chunk);
+                    const size_t size = LZ4F_compressUpdate(
+                        _ctx,_out.data(),_out.size(),s,count,nullptr);
+                    if (LZ4F_isError(size)) return LZ4F_getErrorName(size);
+                    out.write(_out.data(),size);
+                    s += count;
+                    n -= count;
+                }
+                if (f != flush::none) {
+                    const size_t size = f == flush::end
+                        ? LZ4F_compressEnd(_ctx,_out.data(),_out.size(),nullptr)
+                        : LZ4F_flush(_ctx,_out.data(),_out.size(),nullptr);
+                    if (LZ4F_isError(size)) return LZ4F_getErrorName(size);
+                    out.write(_out.data(),size);
+                    _begun = f != flush::end;
+                }
+                return nullptr;
+            }
+
+        };
+
+        class decompressor : interface {
+            LZ4F_dctx* _ctx = nullptr;
+            bool _finished = true;
+
+        public: // structors
+
+            decompressor() {
+                if (LZ4F_isError(LZ4F_createDecompressionContext(&_ctx,LZ4F_VERSION))) {
+                    _ctx = nullptr;
+                }
+            }
+
+            ~decompressor() { LZ4F_freeDecompressionContext(_ctx); }
+
+        public: // decompression
+
+            const char* decompress(
+                const char*& in, const char* in_end,
+                char*& out, char* out_end)
+            {
+                if (not _ctx) return "lz4: LZ4F_createDecompressionContext failed";
+                size_t in_size = size_t(in_end - in);
+                size_t out_size = size_t(out_end - out);
+                const size_t result = LZ4F_decompress(
+                    _ctx,out,&out_size,in,&in_size,nullptr);
+                if (LZ4F_isError(result)) {
+                    return LZ4F_getErrorName(result);
+                }
+                if (in_size or out_size) {
+                    _finished = result == 0;
+                }
+                in += in_size;
+                out += out_size;
+                return nullptr;
+            }
+
+            bool finished() const { return _finished; }
+
+            void reset() {
+                if (_ctx) LZ4F_resetDecompressionContext(_ctx);
+                _finished = true;
+            }
+
+        };
+
+    };
+
+    #endif // reflect_compression_lz4
+
+} // namespace reflect::compression
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  compressing_writer<Format>
+    //
+    //  Compresses everything written to it into the target writer, in blocks
+    //  of about block bytes, so that a codec can encode straight into a
+    //  compressed file or socket without first encoding into memory.
+    //
+    //  flush() writes out everything compressed so far, e.g. after each
+    //  message on a socket, and finish() ends the compressed stream, after
+    //  which writing starts another.  The stream is finished on destruction.
+    //
+    //  EXAMPLE:
+    //
+    //      std::ofstream file("archive.json.zst",std::ios::binary);
+    //      reflect::stream_writer target(file);
+    //      reflect::compressing_writer<reflect::compression::zstd> writer(target);
+    //      json::encoder encoder(writer);
+    //      encoder(records);
+    //
+    template<typename Format>
+    class compressing_writer final : public writer {
+
+        writer& _target;
+
+        const size_t _block;
+
+        typename Format::compressor _compressor;
+
+        std::vector<char> _buffer;
+
+        size_t _offset = 0;
+
+        bool _open = false;
+
+        const char* _error = nullptr;
+
+    public: // structors
+
+        explicit compressing_writer(
+            writer& target,
+            int level = Format::default_level,
+            size_t block = 64 << 10)
+        :_target(target)
+        ,_block(std::max<size_t>(block,1))
+        ,_compressor(level) {
+            _buffer.reserve(_block);
+        }
+
+        ~compressing_writer() { finish(); }
+
+    public: // properties
+
+        //  The message of the error which made the writer false, if any.
+        const char* error() const { return _error; }
+
+    public: // overrides
+
+        using writer::write;
+
+        explicit operator bool() const override {
+            return not _error and bool(_target);
+        }
+
+        //  The number of bytes written, before compression.
+        size_t offset() const override { return _offset; }
+
+        void write(const char* s, size_t n) override {
+            _offset += n;
+            _open = true;
+            if (_buffer.size() + n < _block) {
+                _buffer.insert(_buffer.end(),s,s+n);
+                return;
+            }
+            compress(compression::flush::none);
+            for (; n >= _block; s += _block, n -= _block) {
+                compress(s,_block,compression::flush::none);
+            }
+            _buffer.assign(s,s+n);
+        }
+
+    public: // flushing
+
+        //  Writes everything compressed so far to the target, so that it can
+        //  be decompressed without ending the stream.  Returns false on error.
+        bool flush() {
+            if (_open) compress(compression::flush::block);
+            return operator bool();
+        }
+
+        //  Ends the compressed stream.  Returns false on error.
+        bool finish() {
+            if (_open) compress(compression::flush::end);
+            _open = false;
+            return operator bool();
+        }
+
+    private: // compression
+
+        void compress(compression::flush f) {
+            compress(_buffer.data(),_buffer.size(),f);
+            _buffer.clear();
+        }
+
+        void compress(const char* s, size_t n, compression::flush f) {
+            if (not operator bool()) return;
+            _error = _compressor.compress(s,n,_target,f);
+        }
+
+    };
+
+    //--------------------------------------------------------------------------
+    //  decompressing_reader<Format>
+    //
+    //  Decompresses the source reader as it is read, so that a codec can
+    //  decode straight from a compressed file without first decompressing
+    //  it into memory.  A window of the most recently decompressed bytes,
+    //  at least history bytes behind the current offset, is kept so that
+    //  decoders can look back, and is viewable in place.  Seeking before
+    //  the window restarts decompression from the head of the source.
+    //
+    //  The reader is false at the end of the input, or once the input turns
+    //  out to be corrupt or truncated, as reported by error().
+    //
+    //  EXAMPLE:
+    //
+    //      std::ifstream file("archive.json.zst",std::ios::binary);
+    //      reflect::stream_reader source(file);
+    //      reflect::decompressing_reader<reflect::compression::zstd> reader(source);
+    //      json::decoder decoder(reader);
+    //      decoder(records);
+    //
+    template<typename Format>
+    class decompressing_reader final : public reader {
+
+        reader& _source;
+
+        const size_t _source_head;
+
+        const size_t _history;
+
+        const size_t _block;
+
+        typename Format::decompressor _decompressor;
+
+        std::vector<char> _input;
+
+        size_t _input_offset = 0;
+
+        std::vector<char> _window;
+
+        size_t _head = 0;   // the offset of the window
+
+        size_t _itr = 0;    // the index of the current offset in the window
+
+        size_t _lines = 0;      // the newlines before the window
+
+        size_t _line_head = 0;  // the offset after the last of them
+
+        bool _end = false;
+
+        const char* _error = nullptr;
+
+    public: // structors
+
+        explicit decompressing_reader(
+            reader& source,
+            size_t history = 64 << 10,
+            size_t block = 64 << 10)
+        :_source(source)
+        ,_source_head(source.offset())
+        ,_history(history)
+        ,_block(std::max<size_t>(block,1)) {}
+
+    public: // properties
+
+        //  The message of the error which ended the input early, if any.
+        const char* error() const { return _error; }
+
+    public: // overrides
+
+        explicit operator bool() const override {
+            return _itr < _window.size() or mutable_this().fill();
+        }
+
+        size_t offset() const override { return _head + _itr; }
+
+        char peek() const override {
+            return operator bool() ? _window[_itr] : 0;
+        }
+
+        char read() override {
+            return operator bool() ? _window[_itr++] : 0;
+        }
+
+        void seek(size_t offset) override {
+            if (offset < _head) {
+                rewind();
+            }
+            while (offset > _head + _window.size()) {
+                _itr = _window.size();
+                if (not fill()) break;
+            }
+            _itr = std::min(offset - _head,_window.size());
+        }
+
+        //  Decompresses the rest of the input to measure it.
+        size_t size() const override {
+            decompressing_reader& r = mutable_this();
+            const size_t start = offset();
+            r.seek(size_t(-1));
+            const size_t size = offset();
+            r.seek(start);
+            return size;
+        }
+
+        substring view(size_t offset, size_t size) const override {
+            const size_t tail = _head + _window.size();
+            if (offset < _head or offset > tail or size > tail - offset) {
+                return {};
+            }
+            return substring(_window.data() + (offset - _head),size);
+        }
+
+        void locate(size_t offset, size_t& line, size_t& column) const override {
+            if (offset < _head or offset > _head + _window.size()) {
+                return reader::locate(offset,line,column);
+            }
+            line = 1 + _lines;
+            size_t line_head = _line_head;
+            const char* const head = _window.data();
+            const char* const end = head + (offset - _head);
+            for (const char* itr = head;
+                 (itr = (const char*)memchr(itr,'\n',size_t(end-itr)));
+                 ++itr)
+            {
+                line += 1;
+                line_head = _head + size_t(itr - head) + 1;
+            }
+            column = offset - line_head;
+        }
+
+    private: // decompression
+
+        decompressing_reader& mutable_this() const {
+            return *const_cast<decompressing_reader*>(this);
+        }
+
+        void rewind() {
+            _source.seek(_source_head);
+            _decompressor.reset();
+            _input.clear();
+            _input_offset = 0;
+            _window.clear();
+            _head = 0;
+            _itr = 0;
+            _lines = 0;
+            _line_head = 0;
+            _end = false;
+            _error = nullptr;
+        }
+
+        //  Decompresses at least one more byte into the window, unless at
+        //  the end of the input, first dropping bytes beyond the history.
+        bool fill() {
+            if (_end or _error) return false;
+            if (_itr > _history) {
+                const size_t drop = _itr - _history;
+                count_lines(drop);
+                _window.erase(_window.begin(),_window.begin() + drop);
+                _head += drop;
+                _itr -= drop;
+            }
+            const size_t size = _window.size();
+            _window.resize(size + _block);
+            char* out = _window.data() + size;
+            char* const out_end = _window.data() + _window.size();
+            while (out == _window.data() + size) {
+                if (_input_offset == _input.size() and not read_input()) {
+                    if (not _decompressor.finished()) {
+                        _error = "truncated input";
+                    }
+                    break;
+                }
+                const char* in = _input.data() + _input_offset;
+                const char* const in_end = _input.data() + _input.size();
+                _error = _decompressor.decompress(in,in_end,out,out_end);
+                _input_offset = size_t(in - _input.data());
+                if (_error) break;
+            }
+            _window.resize(size_t(out - _window.data()));
+            _end = _window.size() == size;
+            return not _end;
+        }
+
+        //  Counts the newlines of the first size bytes of the window.
+        void count_lines(size_t size) {
+            const char* const head = _window.data();
+            const char* const end = head + size;
+            for (const char* itr = head;
+                 (itr = (const char*)memchr(itr,'\n',size_t(end-itr)));
+                 ++itr)
+            {
+                _lines += 1;
+                _line_head = _head + size_t(itr - head) + 1;
+            }
+        }
+
+        bool read_input() {
+            const size_t offset = _source.offset();
+            const substring s = _source.view(offset,_block);
+            if (s.size()) {
+                _input.assign(s.begin(),s.end());
+                _source.seek(offset + s.size());
+            } else {
+                _input.clear();
+                while (_input.size() < _block) {
+                    // peeking at the end makes a stream_reader false
+                    const char c = _source.peek();
+                    if (not _source) break;
+                    _input.push_back(c);
+                    _source.read();
+                }
+            }
+            _input_offset = 0;
+            return not _input.empty();
+        }
+
+    };
+
+} // namespace reflect
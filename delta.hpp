@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include "compare.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  delta<T>
+    //
+    //  Reflects, for encoding only, the changes from a baseline value of an
+    //  object type to its current value: the fields and map entries which
+    //  differ, as nested deltas when they are objects themselves, and the
+    //  map entries removed, as null.  Arrays and other values which differ
+    //  are encoded whole.  Encoded as JSON this is the RFC 7386 merge patch
+    //  which transforms baseline into current, see json::apply_patch().
+    //
+    //  Both values must outlive the delta.
+    //
+    //  EXAMPLE:
+    //
+    //      encoder(reflect::delta(previous,state));
+    //
+    template<typename T>
+    class delta {
+
+        static_assert(is_object_v<T>, "delta<T> requires an object type");
+
+        const T& _baseline;
+
+        const T& _current;
+
+    public: // structors
+
+        delta(const T& baseline, const T& current)
+        :_baseline(baseline)
+        ,_current(current) {}
+
+    public: // properties
+
+        const T& baseline() const { return _baseline; }
+
+        const T& current() const { return _current; }
+
+        bool empty() const { return equal(_baseline,_current); }
+
+    public: // reflection
+
+        //  Reflects the changes to reflect, as encode<delta<T>> does.
+        template<class Encoder>
+        void reflect_changes(Encoder& reflect) const {
+            if constexpr(is_map<T>::value) {
+                for_each_entry(_current,[&](const auto& key, const auto& entry){
+                    const auto itr = _baseline.find(entry.first);
+                    if (itr == _baseline.end()) {
+                        reflect(key,entry.second);
+                    } else {
+                        reflect_change(reflect,key,itr->second,entry.second);
+                    }
+                });
+                for_each_entry(_baseline,[&](const auto& key, const auto& entry){
+                    if (_current.find(entry.first) == _current.end()) {
+                        reflect(key,nullptr);
+                    }
+                });
+            } else {
+                for_each_member_pair(_baseline,_current,
+                    [&](const auto& key, const auto& a, const auto& b){
+                        reflect_change(reflect,key,a,b);
+                    });
+            }
+        }
+
+    private: // reflection
+
+        template<class Encoder, typename Key, typename U>
+        static void reflect_change(
+            Encoder& reflect, const Key& key, const U& a, const U& b)
+        {
+            if (equal(a,b)) return;
+            if constexpr(is_object_v<U>) {
+                reflect(key,delta<U>(a,b));
+            } else {
+                reflect(key,b);
+            }
+        }
+
+        //  Calls f(key,entry) for each entry of map, with the key formatted
+        //  by the map's reflection, which visits the entries in order.
+        template<typename Map, typename F>
+        static void for_each_entry(const Map& map, F&& f) {
+            auto itr = map.begin();
+            auto visit = [&](const auto& key, const auto&){
+                f(key,*itr++);
+            };
+            encode<Map>(visit,map);
+        }
+
+    private: // predicates
+
+        template<typename U, typename = void>
+        struct is_map : std::false_type {};
+
+        template<typename U>
+        struct is_map<U,std::void_t<typename U::mapped_type>>
+        : std::true_type {};
+
+    };
+
+} // namespace reflect
+
+reflect_encode_template((typename T),(reflect::delta<T>)) {
+    value.reflect_changes(reflect);
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include <cerrno>
+#include <climits>
+#include <vector>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "writer.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  fd_writer
+    //
+    //  Writes to a POSIX file descriptor with writev().  Small writes, e.g.
+    //  punctuation and numbers, are copied into a staging buffer, while large
+    //  borrowed writes, e.g. cached fragments, are referenced in place until
+    //  the next flush, so that they reach the descriptor without being copied.
+    //  The writer flushes when the staging buffer or the list of fragments
+    //  fills up, on flush(), and on destruction.
+    //
+    //  The descriptor should be blocking; an error, including EAGAIN, makes
+    //  the writer false and is kept in error().
+    //
+    //  EXAMPLE:
+    //
+    //      reflect::fd_writer writer(socket);
+    //      json::encoder encoder(writer);
+    //      encoder(response);
+    //      writer.flush();
+    //
+    class fd_writer final : public writer {
+
+        struct segment {
+            const char* borrowed;   // or nullptr when staged
+            size_t offset;          // in the staging buffer, when staged
+            size_t size;
+        };
+
+        #ifdef IOV_MAX
+        enum : size_t { max_segments = IOV_MAX };
+        #else
+        enum : size_t { max_segments = 16 };
+        #endif
+
+        const int _fd = -1;
+
+        const size_t _threshold;
+
+        const size_t _capacity;
+
+        std::vector<char> _staging;
+
+        std::vector<segment> _segments;
+
+        std::vector<iovec> _iovecs;
+
+        size_t _offset = 0;
+
+        int _error = 0;
+
+    public: // structors
+
+        //  Borrowed writes of at least threshold bytes are referenced, and
+        //  staged writes are flushed once capacity bytes are staged.
+        explicit fd_writer(
+            int fd,
+            size_t threshold = 512,
+            size_t capacity = 64 << 10)
+        :_fd(fd)
+        ,_threshold(threshold)
+        ,_capacity(capacity) {
+            _staging.reserve(capacity);
+        }
+
+        ~fd_writer() { flush(); }
+
+    public: // properties
+
+        int error() const { return _error; }
+
+        size_t pending() const {
+            size_t size = 0;
+            for (const segment& s : _segments) size += s.size;
+            return size;
+        }
+
+    public: // overrides
+
+        explicit operator bool() const override {
+            return _fd >= 0 and not _error;
+        }
+
+        size_t offset() const override { return _offset; }
+
+        void write(const char* s, size_t n) override {
+            if (not operator bool()) return;
+            _offset += n;
+            if (_segments.empty() or _segments.back().borrowed) {
+                add_segment({nullptr,_staging.size(),0});
+            }
+            _staging.insert(_staging.end(),s,s+n);
+            _segments.back().size += n;
+            if (_staging.size() >= _capacity) {
+                flush();
+            }
+        }
+
+        void write_borrowed(const char* s, size_t n) override {
+            if (n < _threshold) {
+                return write(s,n);
+            }
+            if (not operator bool()) return;
+            _offset += n;
+            add_segment({s,0,n});
+        }
+
+    public: // flushing
+
+        //  Writes everything pending to the descriptor, after which borrowed
+        //  bytes are no longer referenced.  Returns false on error.
+        bool flush() {
+            if (_segments.empty() or not operator bool()) {
+                clear();
+                return operator bool();
+            }
+            _iovecs.clear();
+            for (const segment& s : _segments) {
+                const char* const data = s.borrowed
+                                       ? s.borrowed
+                                       : _staging.data() + s.offset;
+                _iovecs.push_back({const_cast<char*>(data),s.size});
+            }
+            iovec* itr = _iovecs.data();
+            iovec* const end = itr + _iovecs.size();
+            while (itr < end) {
+                const ssize_t n = ::writev(_fd,itr,int(end - itr));
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    _error = errno;
+                    break;
+                }
+                // advance past what was written, resuming a partial iovec
+                for (size_t written = size_t(n); itr < end; ++itr) {
+                    if (written < itr->iov_len) {
+                        itr->iov_base = static_cast<char*>(itr->iov_base) + written;
+                        itr->iov_len -= written;
+                        break;
+                    }
+                    written -= itr->iov_len;
+                }
+            }
+            clear();
+            return operator bool();
+        }
+
+    private: // segments
+
+        void add_segment(const segment& s) {
+            if (_segments.size() == max_segments) {
+                flush();
+                if (not s.borrowed) {
+                    // the staging buffer was cleared by the flush
+                    _segments.push_back({nullptr,0,0});
+                    return;
+                }
+            }
+            _segments.push_back(s);
+        }
+
+        void clear() {
+            _staging.clear();
+            _segments.clear();
+        }
+
+    };
+
+} // namespace reflect
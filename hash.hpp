@@ -0,0 +1,175 @@
+#pragma once
+#include <limits>
+#include <type_traits>
+#include "reflect.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  hasher
+    //
+    //  An encoder which, rather than writing its input, folds it into a
+    //  64-bit hash.  Strings and contiguous arrays of integers are hashed as
+    //  raw bytes in bulk.  Values which reflect::equal() considers equal hash
+    //  equally, so floating point numbers are hashed with -0.0 as 0.0, and
+    //  every NaN alike.  Names of reflected fields are fixed by the type and
+    //  are not hashed, while keys of maps are.
+    //
+    class hasher {
+
+        uint64_t _hash;
+
+        enum : uint64_t {
+            aggregate_head = 0x9e3779b97f4a7c15ull,
+            aggregate_tail = 0xc2b2ae3d27d4eb4full,
+        };
+
+    public: // structors
+
+        explicit hasher(uint64_t seed = 0)
+        :_hash(seed) {}
+
+    public: // properties
+
+        uint64_t value() const { return _hash; }
+
+    public: // encoding
+
+        template<typename T>
+        void operator()(const T& in) {
+            if constexpr(is_boolean_v<T>) {
+                return hash_word(in ? 1 : 0);
+            }
+            if constexpr(is_number_v<T>) {
+                return hash_number(in);
+            }
+            if constexpr(is_string_v<T>) {
+                return hash_bytes(in.data(),in.size());
+            }
+            if constexpr(is_contiguous_integers<T>::value) {
+                return hash_bytes(in.data(),in.size()*sizeof(*in.data()));
+            }
+            if constexpr(is_unordered<T>::value) {
+                // equal unordered containers may iterate in any order
+                entries entries;
+                encode<T>(entries,in);
+                hash_word(aggregate_head);
+                hash_word(entries.sum);
+                return hash_word(entries.count);
+            }
+            if constexpr(is_aggregate_v<T>) {
+                hash_word(aggregate_head);
+                encode<T>(*this,in);
+                hash_word(aggregate_tail);
+            }
+        }
+
+        template<typename T>
+        void operator()(substring key, const T& in) {
+            hash_bytes(key.data(),key.size());
+            (*this)(in);
+        }
+
+        template<typename T>
+        void operator()(const field_name&, const T& in) {
+            (*this)(in);
+        }
+
+    private: // hashing
+
+        //  Sums the hashes of the entries of an unordered container.
+        struct entries {
+            uint64_t sum = 0;
+            uint64_t count = 0;
+
+            template<typename T>
+            void operator()(const T& in) {
+                hasher hasher;
+                hasher(in);
+                sum += hasher.value();
+                count += 1;
+            }
+
+            template<typename T>
+            void operator()(substring key, const T& in) {
+                hasher hasher;
+                hasher(key,in);
+                sum += hasher.value();
+                count += 1;
+            }
+        };
+
+        void hash_word(uint64_t word) {
+            _hash = wyhash::mix(_hash ^ wyhash::p0, word ^ wyhash::p1);
+        }
+
+        void hash_bytes(const void* data, size_t size) {
+            _hash = hash64(data,size,_hash);
+        }
+
+        template<typename T>
+        void hash_number(T in) {
+            if constexpr(std::is_floating_point_v<T>) {
+                if (in != in) {
+                    in = std::numeric_limits<T>::quiet_NaN();
+                }
+                in += T(0); // -0.0 + 0.0 is 0.0
+            }
+            if constexpr(sizeof(T) <= sizeof(uint64_t)) {
+                uint64_t word = 0;
+                memcpy(&word,&in,sizeof(T));
+                hash_word(word);
+            } else {
+                // wider types, i.e. long double, may contain padding
+                hash_number(double(in));
+            }
+        }
+
+    private: // predicates
+
+        template<typename T, typename = void>
+        struct is_unordered : std::false_type {};
+
+        template<typename T>
+        struct is_unordered<T,std::void_t<typename T::hasher>>
+        : std::true_type {};
+
+        template<typename T, typename = void>
+        struct is_contiguous_integers : std::false_type {};
+
+        template<typename T>
+        struct is_contiguous_integers<T,std::void_t<
+            decltype(std::declval<const T&>().data()),
+            decltype(std::declval<const T&>().size())
+        >> : std::bool_constant<
+            is_array_v<T>
+            and
+            std::is_integral_v<std::remove_cv_t<std::remove_pointer_t<
+                decltype(std::declval<const T&>().data())
+            >>>
+            and
+            sizeof(*std::declval<const T&>().data()) <= sizeof(uint64_t)
+        > {};
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Hashes the reflected value, e.g. to use reflected types as keys of
+    //  unordered containers.
+    //
+    //  EXAMPLE:
+    //
+    //      struct key_hash {
+    //          size_t operator()(const key& k) const { return reflect::hash(k); }
+    //      };
+    //      std::unordered_map<key,value,key_hash> cache;
+    //
+    template<typename T>
+    size_t hash(const T& value, uint64_t seed = 0) {
+        hasher hasher(seed);
+        hasher(value);
+        return size_t(hasher.value());
+    }
+
+} // namespace reflect
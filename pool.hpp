@@ -0,0 +1,299 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace reflect {
+
+    //  Counters accumulate over the lifetime of a pool, across all threads.
+    struct pool_statistics {
+        size_t acquired = 0;     // items handed out by acquire()
+        size_t thread_hits = 0;  // items reused from the thread's cache
+        size_t shared_hits = 0;  // items reused from the shared overflow
+        size_t created = 0;      // items constructed because none were idle
+        size_t discarded = 0;    // items destroyed because the pool was full
+        size_t high_water = 0;   // the largest capacity() of a released item
+    };
+
+    //--------------------------------------------------------------------------
+    //  pool<T>
+    //
+    //  Keeps idle instances of T, e.g. json::session, for reuse with their
+    //  buffers already grown, so that handling a message neither constructs
+    //  codecs nor allocates scratch buffers once the pool is warm.
+    //
+    //  Each thread keeps up to thread_capacity idle items of its own, which
+    //  are acquired and released without locking or writing shared memory.
+    //  Beyond that, items overflow into a shared list of up to shared_capacity
+    //  items guarded by a mutex, from which any thread may take them, and the
+    //  rest are destroyed.  Items released by a thread that exits are moved
+    //  to the shared list.
+    //
+    //  Released items are reset() when T has a reset() method, and measured
+    //  for the statistics' high water mark when it has a capacity() method.
+    //
+    //  The pool must outlive its leases.  Items cached by other threads when
+    //  the pool is destroyed are destroyed when those threads next use a pool
+    //  of T, or exit.
+    //
+    //  EXAMPLE:
+    //
+    //      static reflect::pool<json::session> sessions;
+    //
+    //      void handle(const request& request, response& response) {
+    //          auto session = sessions.acquire();
+    //          ...
+    //      } // the session is returned to the pool
+    //
+    template<typename T>
+    class pool {
+
+        struct thread_counters {
+            std::atomic<size_t> acquired {0};
+            std::atomic<size_t> thread_hits {0};
+            std::atomic<size_t> shared_hits {0};
+            std::atomic<size_t> created {0};
+            std::atomic<size_t> discarded {0};
+            std::atomic<size_t> high_water {0};
+        };
+
+        struct state {
+            const uint64_t id;
+            const size_t thread_capacity;
+            const size_t shared_capacity;
+            std::mutex mutex;
+            std::vector<std::unique_ptr<T>> items;
+            std::vector<std::shared_ptr<thread_counters>> threads;
+
+            state(uint64_t id, size_t thread_capacity, size_t shared_capacity)
+            :id(id)
+            ,thread_capacity(thread_capacity)
+            ,shared_capacity(shared_capacity) {}
+        };
+
+        //  The items a thread keeps for one pool, and the counters it alone
+        //  writes, which statistics() reads.
+        struct cache {
+            uint64_t id;
+            std::weak_ptr<state> owner;
+            std::shared_ptr<thread_counters> counters;
+            std::vector<std::unique_ptr<T>> items;
+        };
+
+        struct thread_caches {
+            std::vector<cache> caches;
+
+            ~thread_caches() {
+                for (cache& c : caches) {
+                    if (const auto owner = c.owner.lock()) {
+                        overflow(*owner,*c.counters,c.items);
+                    }
+                }
+            }
+        };
+
+        std::shared_ptr<state> _state;
+
+    public: // structors
+
+        explicit pool(size_t thread_capacity = 4, size_t shared_capacity = 64)
+        :_state(std::make_shared<state>(
+            next_id(),thread_capacity,shared_capacity)) {}
+
+        pool(const pool&) = delete;
+
+        pool& operator=(const pool&) = delete;
+
+    public: // leasing
+
+        //  An item on loan from a pool, which returns it on destruction.
+        class lease {
+
+            pool* _pool = nullptr;
+
+            std::unique_ptr<T> _item;
+
+            friend class pool;
+
+            lease(pool& pool, std::unique_ptr<T> item)
+            :_pool(&pool)
+            ,_item(std::move(item)) {}
+
+        public: // structors
+
+            lease() = default;
+
+            lease(lease&& other) = default;
+
+            lease& operator=(lease&& other) {
+                if (this != &other) {
+                    release();
+                    _pool = other._pool;
+                    _item = std::move(other._item);
+                }
+                return *this;
+            }
+
+            ~lease() { release(); }
+
+        public: // properties
+
+            explicit operator bool() const { return bool(_item); }
+
+            T& operator*() const { return *_item; }
+
+            T* operator->() const { return _item.get(); }
+
+            T* get() const { return _item.get(); }
+
+        public: // releasing
+
+            //  Returns the item to the pool before the lease is destroyed.
+            void release() {
+                if (_item) _pool->release(std::move(_item));
+            }
+
+        };
+
+        //  Returns an idle item, or a new one when none is idle.
+        lease acquire() {
+            cache& c = local();
+            increment(c.counters->acquired);
+            if (not c.items.empty()) {
+                increment(c.counters->thread_hits);
+                std::unique_ptr<T> item = std::move(c.items.back());
+                c.items.pop_back();
+                return lease(*this,std::move(item));
+            }
+            {
+                std::lock_guard<std::mutex> lock(_state->mutex);
+                if (not _state->items.empty()) {
+                    increment(c.counters->shared_hits);
+                    std::unique_ptr<T> item = std::move(_state->items.back());
+                    _state->items.pop_back();
+                    return lease(*this,std::move(item));
+                }
+            }
+            increment(c.counters->created);
+            return lease(*this,std::make_unique<T>());
+        }
+
+    public: // properties
+
+        pool_statistics statistics() const {
+            pool_statistics s;
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            for (const auto& c : _state->threads) {
+                s.acquired += c->acquired.load(std::memory_order_relaxed);
+                s.thread_hits += c->thread_hits.load(std::memory_order_relaxed);
+                s.shared_hits += c->shared_hits.load(std::memory_order_relaxed);
+                s.created += c->created.load(std::memory_order_relaxed);
+                s.discarded += c->discarded.load(std::memory_order_relaxed);
+                s.high_water = std::max(s.high_water,
+                    c->high_water.load(std::memory_order_relaxed));
+            }
+            return s;
+        }
+
+    private: // releasing
+
+        void release(std::unique_ptr<T> item) {
+            if constexpr(has_reset<T>::value) {
+                item->reset();
+            }
+            cache& c = local();
+            if constexpr(has_capacity<T>::value) {
+                const size_t capacity = item->capacity();
+                if (capacity > c.counters->high_water.load(std::memory_order_relaxed)) {
+                    c.counters->high_water.store(capacity,std::memory_order_relaxed);
+                }
+            }
+            if (c.items.size() < _state->thread_capacity) {
+                c.items.push_back(std::move(item));
+                return;
+            }
+            std::vector<std::unique_ptr<T>> items;
+            items.push_back(std::move(item));
+            overflow(*_state,*c.counters,items);
+        }
+
+        //  Moves items into the shared list, destroying those which exceed
+        //  its capacity outside the lock.
+        static void overflow(
+            state& s, thread_counters& c, std::vector<std::unique_ptr<T>>& items)
+        {
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                while (not items.empty() and s.items.size() < s.shared_capacity) {
+                    s.items.push_back(std::move(items.back()));
+                    items.pop_back();
+                }
+            }
+            c.discarded.store(
+                c.discarded.load(std::memory_order_relaxed) + items.size(),
+                std::memory_order_relaxed);
+            items.clear();
+        }
+
+    private: // thread caches
+
+        //  Returns this thread's cache for this pool, registering one on the
+        //  thread's first use of the pool.
+        cache& local() {
+            thread_local thread_caches caches;
+            for (cache& c : caches.caches) {
+                if (c.id == _state->id) return c;
+            }
+            // drop the caches of pools which have been destroyed
+            caches.caches.erase(
+                std::remove_if(caches.caches.begin(),caches.caches.end(),
+                    [](const cache& c){ return c.owner.expired(); }),
+                caches.caches.end());
+            auto counters = std::make_shared<thread_counters>();
+            {
+                std::lock_guard<std::mutex> lock(_state->mutex);
+                _state->threads.push_back(counters);
+            }
+            caches.caches.push_back({_state->id,_state,counters,{}});
+            return caches.caches.back();
+        }
+
+        //  Counters are only written by their own thread, so incrementing
+        //  needs no atomic read-modify-write.
+        static void increment(std::atomic<size_t>& counter) {
+            counter.store(
+                counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        }
+
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> id {0};
+            return id.fetch_add(1,std::memory_order_relaxed);
+        }
+
+    private: // predicates
+
+        template<typename U, typename = void>
+        struct has_reset : std::false_type {};
+
+        template<typename U>
+        struct has_reset<U,std::void_t<
+            decltype(std::declval<U&>().reset())
+        >> : std::true_type {};
+
+        template<typename U, typename = void>
+        struct has_capacity : std::false_type {};
+
+        template<typename U>
+        struct has_capacity<U,std::void_t<
+            decltype(size_t(std::declval<const U&>().capacity()))
+        >> : std::true_type {};
+
+    };
+
+} // namespace reflect
@@ -0,0 +1,339 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "reflect.hpp"
+
+namespace reflect {
+
+    //--------------------------------------------------------------------------
+    //  profile
+    //
+    //  Aggregates the time and bytes spent per reflected type, and per field
+    //  of each type, as recorded by a profiling_codec.  Total time includes
+    //  nested values, counted once for recursive types; self time excludes
+    //  them.  When constructed with trace enabled, every value is also
+    //  recorded as an event for write_trace().
+    //
+    class profile {
+    public: // types
+
+        using clock = std::chrono::steady_clock;
+
+        struct timing {
+            size_t calls = 0;
+            size_t bytes = 0;
+            clock::duration total {};
+            clock::duration self {};
+            unsigned active = 0;
+        };
+
+        struct type_timing : timing {
+            std::map<std::string,timing,std::less<>> fields;
+        };
+
+        using table = std::map<std::string,type_timing,std::less<>>;
+
+    private:
+
+        struct frame {
+            type_timing* type;
+            timing* field;
+            const std::string* type_name;
+            const std::string* field_name;
+            clock::time_point start;
+            clock::duration children;
+            size_t offset;
+            bool keyed;
+        };
+
+        struct event {
+            const std::string* type_name;
+            const std::string* field_name;
+            clock::duration start;
+            clock::duration duration;
+        };
+
+        table _types;
+
+        std::vector<frame> _stack;
+
+        std::vector<event> _events;
+
+        bool _trace = false;
+
+        clock::time_point _epoch = clock::now();
+
+    public: // structors
+
+        explicit profile(bool trace = false)
+        :_trace(trace) {}
+
+    public: // properties
+
+        const table& types() const { return _types; }
+
+        void clear() {
+            _types.clear();
+            _stack.clear();
+            _events.clear();
+            _epoch = clock::now();
+        }
+
+    public: // recording
+
+        //  Begins timing a value of type T, which is the named field of the
+        //  enclosing value unless field is empty.
+        template<typename T>
+        void enter(substring field, size_t offset) {
+            static const std::string type_name = to_string(nameof<T>());
+            auto type = _types.try_emplace(type_name).first;
+            frame f {
+                &type->second, nullptr, &type->first, nullptr,
+                {}, {}, offset, is_keyed<T>::value
+            };
+            if (not field.empty() and not _stack.empty()) {
+                // entries of maps are keyed by data, not by schema
+                const frame& parent = _stack.back();
+                const std::string_view name = parent.keyed
+                    ? std::string_view("[]")
+                    : std::string_view(field.begin(),field.size());
+                auto& fields = parent.type->fields;
+                auto itr = fields.find(name);
+                if (itr == fields.end()) {
+                    itr = fields.emplace(std::string(name),timing()).first;
+                }
+                f.field = &itr->second;
+                f.field_name = &itr->first;
+            }
+            f.type->active += 1;
+            if (f.field) f.field->active += 1;
+            _stack.push_back(f);
+            _stack.back().start = clock::now();
+        }
+
+        //  Ends timing the innermost value, discarding it unless completed,
+        //  e.g. when a decoder reached the end of an array.
+        void leave(bool completed, size_t offset) {
+            const auto end = clock::now();
+            const frame f = _stack.back();
+            _stack.pop_back();
+            const auto elapsed = end - f.start;
+            const size_t bytes = offset > f.offset ? offset - f.offset : 0;
+            auto record = [&](timing& t){
+                t.active -= 1;
+                if (not completed) return;
+                t.calls += 1;
+                t.self += elapsed - f.children;
+                if (t.active == 0) {
+                    t.total += elapsed;
+                    t.bytes += bytes;
+                }
+            };
+            record(*f.type);
+            if (f.field) record(*f.field);
+            if (not _stack.empty()) {
+                _stack.back().children += elapsed;
+            }
+            if (_trace and completed) {
+                _events.push_back({
+                    f.type_name, f.field_name, f.start - _epoch, elapsed
+                });
+            }
+        }
+
+    public: // reporting
+
+        //  Writes a table of types and their fields, slowest first.
+        void report(std::ostream& out) const {
+            auto row = [&](const std::string& name, const timing& t) {
+                char line[160];
+                snprintf(line,sizeof(line),"%-40s %10zu %12.3f %12.3f %12zu\n",
+                    name.c_str(),t.calls,ms(t.total),ms(t.self),t.bytes);
+                out << line;
+            };
+            char header[160];
+            snprintf(header,sizeof(header),"%-40s %10s %12s %12s %12s\n",
+                "type / field","calls","total ms","self ms","bytes");
+            out << header;
+            for (auto type : by_total(_types)) {
+                row(type->first,type->second);
+                for (auto field : by_total(type->second.fields)) {
+                    row("    ." + field->first,field->second);
+                }
+            }
+        }
+
+        //  Writes the recorded events in the Chrome trace event format, for
+        //  viewing in chrome://tracing or Perfetto.
+        void write_trace(std::ostream& out) const {
+            out << "{\"traceEvents\":[";
+            const char* comma = "\n";
+            for (const event& e : _events) {
+                out << comma << "{\"name\":";
+                write_string(out,e.field_name ? *e.field_name : *e.type_name);
+                out << ",\"cat\":\"" << (e.field_name ? "field" : "type") << "\"";
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":1";
+                out << ",\"ts\":" << us(e.start) << ",\"dur\":" << us(e.duration);
+                out << ",\"args\":{\"type\":";
+                write_string(out,*e.type_name);
+                out << "}}";
+                comma = ",\n";
+            }
+            out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        }
+
+    private: // utility
+
+        template<typename T, typename = void>
+        struct is_keyed : std::false_type {};
+
+        template<typename T>
+        struct is_keyed<T,std::void_t<typename T::mapped_type>>
+        : std::true_type {};
+
+        static std::string to_string(substring s) {
+            return std::string(s.begin(),s.size());
+        }
+
+        static double ms(clock::duration d) {
+            return std::chrono::duration<double,std::milli>(d).count();
+        }
+
+        static double us(clock::duration d) {
+            return std::chrono::duration<double,std::micro>(d).count();
+        }
+
+        template<typename Map>
+        static std::vector<typename Map::const_iterator> by_total(const Map& map) {
+            std::vector<typename Map::const_iterator> v;
+            for (auto itr = map.begin(); itr != map.end(); ++itr) {
+                v.push_back(itr);
+            }
+            std::stable_sort(v.begin(),v.end(),[](auto a, auto b){
+                return a->second.total > b->second.total;
+            });
+            return v;
+        }
+
+        static void write_string(std::ostream& out, const std::string& s) {
+            out << '"';
+            for (const char c : s) {
+                if (c == '"' or c == '\\') {
+                    out << '\\' << c;
+                } else if (uint8_t(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped,sizeof(escaped),"\\u%04x",unsigned(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+
+    };
+
+    //--------------------------------------------------------------------------
+    //  profiling_codec<Codec>
+    //
+    //  Wraps an encoder or decoder, recording into a profile the time and
+    //  bytes spent on each reflected type and field.  The codec delegates
+    //  the fields of aggregates back through the wrapper, so every nested
+    //  value is recorded.  Bytes are measured by the codec's offset(), and
+    //  so are not attributed to fields that a decoder looks up by name.
+    //
+    //  EXAMPLE:
+    //
+    //      reflect::profile profile;
+    //      json::encoder encoder(writer);
+    //      reflect::profiling_codec profiler(encoder,profile);
+    //      profiler(value);
+    //      profile.report(std::cout);
+    //
+    template<typename Codec>
+    class profiling_codec {
+
+        Codec& _codec;
+
+        profile& _profile;
+
+    public: // structors
+
+        profiling_codec(Codec& codec, profile& profile)
+        :_codec(codec)
+        ,_profile(profile) {}
+
+    public: // properties
+
+        Codec& codec() const { return _codec; }
+
+    public: // reflection
+
+        template<typename T>
+        auto operator()(T&& value) {
+            using U = std::decay_t<T>;
+            return record<U>(nullptr,[&]{
+                return _codec.delegate(*this,value);
+            });
+        }
+
+        template<typename T>
+        auto operator()(substring key, T&& value) {
+            using U = std::decay_t<T>;
+            return record<U>(key,[&]{
+                return _codec.delegate(*this,key,value);
+            });
+        }
+
+        template<typename C = Codec>
+        auto operator()(substring* key)
+        -> decltype(std::declval<C&>()(key)) {
+            return _codec(key);
+        }
+
+        template<typename T>
+        auto operator()(substring* key, T& value) {
+            return record<T>("[]",[&]{
+                return _codec.delegate(*this,key,value);
+            });
+        }
+
+        template<typename C = Codec>
+        auto size_hint()
+        -> decltype(std::declval<C&>().size_hint()) {
+            return _codec.size_hint();
+        }
+
+    private: // recording
+
+        template<typename T, typename F>
+        auto record(substring field, F&& f) {
+            _profile.enter<T>(field,offset(_codec,0));
+            if constexpr(std::is_void_v<decltype(f())>) {
+                f();
+                _profile.leave(true,offset(_codec,0));
+            } else {
+                auto result = f();
+                _profile.leave(bool(result),offset(_codec,0));
+                return result;
+            }
+        }
+
+        template<typename C>
+        static auto offset(C& codec, int) -> decltype(size_t(codec.offset())) {
+            return codec.offset();
+        }
+
+        template<typename C>
+        static size_t offset(C&, long) { return 0; }
+
+    };
+
+} // namespace reflect
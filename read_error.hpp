@@ -5,24 +5,28 @@
 namespace reflect {
 
     class read_error final {
-        reader* _reader = reader::null;
+        ::reflect::reader* _reader = ::reflect::reader::null;
         const char* _message = nullptr;
         size_t _offset = 0;
         size_t _size = 0;
+        size_t _line = 0;
+        size_t _column = 0;
 
     public: // structors
 
         read_error() = default;
 
         read_error(
-            reader& reader,
+            ::reflect::reader& reader,
             const char* message,
             size_t offset,
             size_t size)
         :_reader(&reader)
         ,_message(message)
         ,_offset(offset)
-        ,_size(size) {}
+        ,_size(size) {
+            reader.locate(offset,_line,_column);
+        }
 
     public: // operators
 
@@ -30,28 +34,24 @@ namespace reflect {
 
     public: // properties
 
-        reader& reader() const { return *_reader; }
+        ::reflect::reader& reader() const { return *_reader; }
 
         const char* message() const { return _message; }
 
         size_t offset() const { return _offset; }
 
         size_t size() const { return _size; }
+
+        size_t line() const { return _line; }
+
+        size_t column() const { return _column; }
     };
 
     std::ostream& operator<<(std::ostream& o, const read_error& e) {
         if (e) {
             auto& reader = e.reader();
             const size_t offset = e.offset();
-            size_t line = 1, column = 0;
-            reader.seek(0);
-            while (reader.offset() < offset) {
-                const char c = reader.read();
-                const bool is_newline = c == '\n';
-                column = (column + 1) * not is_newline;
-                line += is_newline;
-            }
-            o << line << ":" << column << ": " << e.message();
+            o << e.line() << ":" << e.column() << ": " << e.message();
             const size_t size = e.size();
             if (size > 0) {
                 o << ": \"" << reader.peek(offset,size) << "\"";
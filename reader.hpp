@@ -1,5 +1,7 @@
 #pragma once
+#include <cstring>
 #include <istream>
+#include <vector>
 #include "interface.hpp"
 #include "substring.hpp"
 
@@ -28,6 +30,13 @@ namespace reflect {
         virtual void seek(size_t offset) = 0;
 
         virtual size_t size() const = 0;
+
+        // returns the requested bytes in place when the input is contiguous
+        // in memory, otherwise an empty substring
+        virtual substring view(size_t, size_t) const { return {}; }
+
+        // computes the 1-based line and 0-based column of offset
+        virtual void locate(size_t offset, size_t& line, size_t& column) const;
     };
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -65,6 +74,33 @@ namespace reflect {
         reflect_assert(r.offset()==start);
     }
 
+    inline void
+    reader::locate(size_t offset, size_t& line, size_t& column) const {
+        line = 1;
+        column = 0;
+        const substring s = view(0,offset);
+        if (s.size() == offset) {
+            const char* head = s.begin();
+            const char* const end = s.end();
+            while (auto n = (const char*)memchr(head,'\n',size_t(end-head))) {
+                line += 1;
+                head = n + 1;
+            }
+            column = size_t(end - head);
+            return;
+        }
+        reader& r = *const_cast<reader*>(this);
+        const auto start = this->offset();
+        r.seek(0);
+        while (r and r.offset() < offset) {
+            const char c = r.read();
+            const bool is_newline = c == '\n';
+            column = (column + 1) * not is_newline;
+            line += is_newline;
+        }
+        r.seek(start);
+    }
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
     struct reader::null_reader final : reader {
@@ -82,7 +118,7 @@ namespace reflect {
 
         char read() override { return 0; }
 
-        void seek(size_t offset) override {}
+        void seek(size_t) override {}
 
         size_t size() const override { return 0; }
 
@@ -98,6 +134,16 @@ namespace reflect {
         std::istream* const _stream = nullptr;
         const pos_type _head;
 
+        // newline index, sampled every block bytes as the stream is first
+        // read, so that locate() never rescans from the head of the stream
+        enum : size_t { block = 4096 };
+        struct checkpoint { size_t lines, line_head; };
+        std::vector<checkpoint> _checkpoints;
+        size_t _position = 0;
+        size_t _indexed = 0;
+        size_t _lines = 0;
+        size_t _line_head = 0;
+
     public: // structors
 
         stream_reader() = default;
@@ -112,20 +158,31 @@ namespace reflect {
             return _stream and _stream->good();
         }
 
-        size_t offset() const override {
-            return operator bool() ? size_t(_stream->tellg()-_head) : 0;
-        }
+        // tracked rather than asked of the stream, which has no position
+        // once it reaches the end or fails
+        size_t offset() const override { return _position; }
 
         char peek() const override {
             return operator bool() ? _stream->peek() : 0;
         }
 
         char read() override {
-            return operator bool() ? _stream->get() : 0;
+            if (not operator bool()) return 0;
+            const auto c = _stream->get();
+            if (c != std::istream::traits_type::eof()) {
+                index(char(c));
+            }
+            return c;
         }
 
+        // seeking back from the end of the stream resumes reading, as it
+        // does for the other readers
         void seek(size_t offset) override {
-            if (operator bool()) _stream->seekg(_head + off_type(offset));
+            if (_stream and not _stream->bad()) {
+                _stream->clear();
+                _stream->seekg(_head + off_type(offset));
+                _position = offset;
+            }
         }
 
         size_t size() const override {
@@ -139,6 +196,53 @@ namespace reflect {
             return 0;
         }
 
+        void locate(size_t offset, size_t& line, size_t& column) const override {
+            if (offset == _indexed) {
+                line = 1 + _lines;
+                column = offset - _line_head;
+                return;
+            }
+            if (not _stream) {
+                return reader::locate(offset,line,column);
+            }
+            // rescanning seeks, which resumes a stream that has reached its
+            // end, so its state is restored when done
+            const auto state = _stream->rdstate();
+            if (offset > _indexed) {
+                reader::locate(offset,line,column);
+            } else {
+                const checkpoint& c = _checkpoints[offset / block];
+                line = 1 + c.lines;
+                size_t line_head = c.line_head;
+                stream_reader& r = *const_cast<stream_reader*>(this);
+                const auto start = r.offset();
+                r.seek(offset / block * block);
+                while (r and _position < offset) {
+                    if (r.read() == '\n') {
+                        line += 1;
+                        line_head = _position;
+                    }
+                }
+                r.seek(start);
+                column = offset - line_head;
+            }
+            _stream->clear(state);
+        }
+
+    private: // indexing
+
+        void index(char c) {
+            if (_position++ != _indexed) return;
+            if (_indexed % block == 0) {
+                _checkpoints.push_back({_lines,_line_head});
+            }
+            _indexed += 1;
+            if (c == '\n') {
+                _lines += 1;
+                _line_head = _indexed;
+            }
+        }
+
     };
 
     //--------------------------------------------------------------------------
@@ -193,6 +297,11 @@ namespace reflect {
             return _string.size();
         }
 
+        substring view(size_t offset, size_t size) const override {
+            if (offset > _string.size()) return {};
+            return _string.skip(offset).prefix(size);
+        }
+
     };
 
 } // namespace reflect
@@ -1,11 +1,23 @@
 #pragma once
+#include <charconv>
+#include <memory>
 #include <sstream>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include "map.h"
 #include "substring.hpp"
 
 namespace reflect {
 
+    template<typename T>
+    struct is_null : std::is_null_pointer<T> {};
+
+    template<typename T>
+    static inline constexpr bool is_null_v { is_null<T>::value };
+
+    //--------------------------------------------------------------------------
+
     template<typename T>
     struct is_boolean : std::is_same<T,bool> {};
 
@@ -14,6 +26,19 @@ namespace reflect {
 
     //--------------------------------------------------------------------------
 
+    //  Character types, which streams format as characters, not numbers.
+    template<typename T>
+    struct is_character : std::bool_constant<
+        std::is_same_v<T,char> or
+        std::is_same_v<T,signed char> or
+        std::is_same_v<T,unsigned char>
+    > {};
+
+    template<typename T>
+    static inline constexpr bool is_character_v { is_character<T>::value };
+
+    //--------------------------------------------------------------------------
+
     template<typename T>
     struct is_number : std::is_arithmetic<T> {};
 
@@ -25,8 +50,8 @@ namespace reflect {
     template<typename>
     struct is_string : std::false_type {};
 
-    template<>
-    struct is_string<std::string> : std::true_type {};
+    template<typename Traits, typename Allocator>
+    struct is_string<std::basic_string<char,Traits,Allocator>> : std::true_type {};
 
     template<typename T>
     static inline constexpr bool is_string_v { is_string<T>::value };
@@ -35,6 +60,8 @@ namespace reflect {
 
     template<typename T>
     static inline constexpr bool is_terminal_v {
+        is_null_v<T>
+        or
         is_boolean_v<T>
         or
         is_number_v<T>
@@ -73,6 +100,84 @@ namespace reflect {
 
     //--------------------------------------------------------------------------
 
+    //  Constructs a T using the given allocator when T is allocator-aware,
+    //  e.g. so that elements decoded into a std::pmr container are allocated
+    //  from the same memory resource as the container itself.
+    template<typename T, typename Allocator>
+    T make_using_allocator(const Allocator& allocator) {
+        if constexpr(not std::uses_allocator_v<T,Allocator>) {
+            return T();
+        } else if constexpr(
+            std::is_constructible_v<T,std::allocator_arg_t,const Allocator&>
+        ) {
+            return T(std::allocator_arg,allocator);
+        } else {
+            return T(allocator);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    //  True when the keys of Map can be looked up without constructing a
+    //  key_type, e.g. std::map<std::string,T,std::less<>>.  Only ordered
+    //  maps with a transparent comparator are detected; unordered maps
+    //  always construct a key_type to look up a key.
+    template<typename Map, typename = void>
+    struct has_transparent_lookup : std::false_type {};
+
+    template<typename Map>
+    struct has_transparent_lookup<
+        Map, std::void_t<typename Map::key_compare::is_transparent>
+    > : std::true_type {};
+
+    template<typename Map>
+    static inline constexpr bool has_transparent_lookup_v {
+        has_transparent_lookup<Map>::value
+    };
+
+    //--------------------------------------------------------------------------
+
+    template<typename T, typename = void>
+    struct has_reserve : std::false_type {};
+
+    template<typename T>
+    struct has_reserve<
+        T, std::void_t<decltype(std::declval<T&>().reserve(size_t()))>
+    > : std::true_type {};
+
+    template<typename T>
+    static inline constexpr bool has_reserve_v { has_reserve<T>::value };
+
+    template<typename Decoder, typename = void>
+    struct has_size_hint : std::false_type {};
+
+    template<typename Decoder>
+    struct has_size_hint<
+        Decoder,
+        std::void_t<decltype(size_t(std::declval<Decoder&>().size_hint()))>
+    > : std::true_type {};
+
+    template<typename Decoder>
+    static inline constexpr bool has_size_hint_v {
+        has_size_hint<Decoder>::value
+    };
+
+    //  Reserves room in a container for the elements which a decoder expects
+    //  to follow, when the decoder offers a size_hint() and the container a
+    //  reserve().  Decoders must not hint at more elements than their input
+    //  holds, though hints beyond the container's max_size() are ignored.
+    template<typename Decoder, typename Container>
+    void reserve_hinted(Decoder& decoder, Container& container) {
+        if constexpr(has_size_hint_v<Decoder> and has_reserve_v<Container>) {
+            const size_t hint = decoder.size_hint();
+            if (hint and hint <= container.max_size() - container.size()) {
+                container.reserve(container.size() + hint);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
     template<typename T>
     substring nameof() {
         return
@@ -83,6 +188,87 @@ namespace reflect {
 
     //--------------------------------------------------------------------------
 
+    //  The name of a field declared by reflect_fields(), passed to encoders
+    //  in place of a substring.  Being an identifier, the name never needs
+    //  escaping, so its quoted form, "name":, is prepared at compile time.
+    class field_name : public substring {
+        const char* _quoted;
+
+    public: // structors
+
+        template<size_t NAME, size_t QUOTED>
+        constexpr field_name(const char (&name)[NAME], const char (&quoted)[QUOTED])
+        :substring(name,NAME-1)
+        ,_quoted(quoted) {
+            static_assert(QUOTED == NAME + 3);
+        }
+
+    public: // properties
+
+        //  The name in double quotes, followed by a colon.
+        substring quoted() const { return substring(_quoted,size()+3); }
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Describes a field declared by reflect_fields(), its name and member
+    //  pointer.
+    template<typename Class, typename T>
+    struct field {
+        using class_type = Class;
+        using value_type = T;
+
+        std::string_view name;
+        T Class::* member;
+
+        constexpr T& operator()(Class& c) const { return c.*member; }
+
+        constexpr const T& operator()(const Class& c) const { return c.*member; }
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  The fields declared by reflect_fields(), as a constexpr tuple of field
+    //  descriptors in declaration order.  Types reflected otherwise, e.g. by
+    //  reflect_type(), have no fields.
+    //
+    //  EXAMPLE:
+    //
+    //      static_assert(reflect::fields<foo>::size == 2);
+    //      static_assert(std::get<0>(reflect::fields<foo>::value).name == "i");
+    //
+    template<typename T>
+    struct fields {
+    private:
+        template<typename U>
+        static constexpr auto descriptors(int)
+        -> decltype(U::template reflect_field_descriptors<U>()) {
+            return U::template reflect_field_descriptors<U>();
+        }
+
+        template<typename U>
+        static constexpr std::tuple<> descriptors(long) { return {}; }
+
+    public:
+        static constexpr auto value = descriptors<T>(0);
+
+        static constexpr size_t size = std::tuple_size_v<decltype(value)>;
+    };
+
+    template<typename T>
+    static inline constexpr bool has_fields_v { fields<T>::size > 0 };
+
+    //  Calls f(name,member) for each field of obj, unrolled at compile time,
+    //  in the same form as reflect_fields() calls a codec.
+    template<typename T, typename F>
+    constexpr void for_each_field(T& obj, F&& f) {
+        std::apply([&](const auto&... d){
+            (f(substring(d.name.data(),d.name.size()),d(obj)),...);
+        },fields<std::remove_const_t<T>>::value);
+    }
+
+    //--------------------------------------------------------------------------
+
     template<typename T>
     struct decode {
         template<class Decoder>
@@ -115,6 +301,17 @@ namespace reflect {
         }
     };
 
+    //--------------------------------------------------------------------------
+
+    //  The type argument of a specialization such as decode<T>, which the
+    //  macros below use to name T within the specialization, where a name
+    //  like field would otherwise find reflect::field.
+    template<typename Specialization>
+    struct argument_of;
+
+    template<template<typename> class Template, typename T>
+    struct argument_of<Template<T>> { using type = T; };
+
 } // namespace reflect
 
 
@@ -133,7 +330,7 @@ namespace reflect {
 //
 #define reflect_is_array_type(Name) \
     template<> \
-    struct ::reflect::is_array<_reflect_unpack(Name)>:std::true_type {};
+    struct reflect::is_array<_reflect_unpack(Name)>:std::true_type {}
 
 
 //------------------------------------------------------------------------------
@@ -147,7 +344,7 @@ namespace reflect {
 //
 #define reflect_is_array_template(Parameters,Name) \
     template<_reflect_unpack(Parameters)> \
-    struct ::reflect::is_array<_reflect_unpack(Name)>:std::true_type {};
+    struct reflect::is_array<_reflect_unpack(Name)>:std::true_type {}
 
 
 //------------------------------------------------------------------------------
@@ -166,13 +363,14 @@ namespace reflect {
 //
 #define reflect_decode_type(Name) \
     template<> \
-    struct ::reflect::decode<_reflect_unpack(Name)> { \
+    struct reflect::decode<_reflect_unpack(Name)> { \
+        using value_type = typename ::reflect::argument_of<decode>::type; \
         template<class Decoder> \
-        decode(Decoder& reflect, _reflect_unpack(Name)& value); \
+        decode(Decoder& reflect, value_type& value); \
     }; \
     template<class Decoder> \
     ::reflect::decode<_reflect_unpack(Name)>:: \
-    decode(Decoder& reflect, _reflect_unpack(Name)& value)
+    decode(Decoder& reflect, value_type& value)
 
 
 //------------------------------------------------------------------------------
@@ -191,14 +389,15 @@ namespace reflect {
 //
 #define reflect_decode_template(Parameters,Name) \
     template<_reflect_unpack(Parameters)> \
-    struct ::reflect::decode<_reflect_unpack(Name)> { \
+    struct reflect::decode<_reflect_unpack(Name)> { \
+        using value_type = typename ::reflect::argument_of<decode>::type; \
         template<class Decoder> \
-        decode(Decoder& reflect, _reflect_unpack(Name)& value); \
+        decode(Decoder& reflect, value_type& value); \
     }; \
     template<_reflect_unpack(Parameters)> \
     template<class Decoder> \
     ::reflect::decode<_reflect_unpack(Name)>:: \
-    decode(Decoder& reflect, _reflect_unpack(Name)& value)
+    decode(Decoder& reflect, value_type& value)
 
 
 //------------------------------------------------------------------------------
@@ -217,13 +416,14 @@ namespace reflect {
 //
 #define reflect_encode_type(Name) \
     template<> \
-    struct ::reflect::encode<_reflect_unpack(Name)> { \
+    struct reflect::encode<_reflect_unpack(Name)> { \
+        using value_type = typename ::reflect::argument_of<encode>::type; \
         template<class Encoder> \
-        encode(Encoder& reflect, const _reflect_unpack(Name)& value); \
+        encode(Encoder& reflect, const value_type& value); \
     }; \
     template<class Encoder> \
     ::reflect::encode<_reflect_unpack(Name)>:: \
-    encode(Encoder& reflect, const _reflect_unpack(Name)& value)
+    encode(Encoder& reflect, const value_type& value)
 
 
 //------------------------------------------------------------------------------
@@ -242,14 +442,15 @@ namespace reflect {
 //
 #define reflect_encode_template(Parameters,Name) \
     template<_reflect_unpack(Parameters)> \
-    struct ::reflect::encode<_reflect_unpack(Name)> { \
+    struct reflect::encode<_reflect_unpack(Name)> { \
+        using value_type = typename ::reflect::argument_of<encode>::type; \
         template<class Encoder> \
-        encode(Encoder& reflect, const _reflect_unpack(Name)& value); \
+        encode(Encoder& reflect, const value_type& value); \
     }; \
     template<_reflect_unpack(Parameters)> \
     template<class Encoder> \
     ::reflect::encode<_reflect_unpack(Name)>:: \
-    encode(Encoder& reflect, const _reflect_unpack(Name)& value)
+    encode(Encoder& reflect, const value_type& value)
 
 
 //------------------------------------------------------------------------------
@@ -271,15 +472,15 @@ namespace reflect {
 //
 #define reflect_type(Name) \
     template<> \
-    struct ::reflect::transcode<_reflect_unpack(Name)> { \
+    struct reflect::transcode<_reflect_unpack(Name)> { \
         template<class Codec, typename Const_Or_NonConst> \
         transcode(Codec& reflect, Const_Or_NonConst& value); \
     }; \
     reflect_decode_type(Name) { \
-        ::reflect::transcode<_reflect_unpack(Name)>(reflect, value); \
+        ::reflect::transcode<value_type>(reflect, value); \
     } \
     reflect_encode_type(Name) { \
-        ::reflect::transcode<_reflect_unpack(Name)>(reflect, value); \
+        ::reflect::transcode<value_type>(reflect, value); \
     } \
     template<class Codec, typename Const_Or_NonConst> \
     ::reflect::transcode<_reflect_unpack(Name)>:: \
@@ -306,15 +507,15 @@ namespace reflect {
 //
 #define reflect_template(Parameters,Name) \
     template<_reflect_unpack(Parameters)> \
-    struct ::reflect::transcode<_reflect_unpack(Name)> { \
+    struct reflect::transcode<_reflect_unpack(Name)> { \
         template<class Codec, typename Const_Or_NonConst> \
         transcode(Codec& reflect, Const_Or_NonConst& value); \
     }; \
     reflect_decode_template(Parameters,Name) { \
-        ::reflect::transcode<_reflect_unpack(Name)>(reflect, value); \
+        ::reflect::transcode<value_type>(reflect, value); \
     } \
     reflect_encode_template(Parameters,Name) { \
-        ::reflect::transcode<_reflect_unpack(Name)>(reflect, value); \
+        ::reflect::transcode<value_type>(reflect, value); \
     } \
     template<_reflect_unpack(Parameters)> \
     template<class Codec, typename Const_Or_NonConst> \
@@ -332,6 +533,8 @@ namespace reflect {
 //      template<typename Decoder> void reflect_fields(Decoder& reflect);
 //      template<typename Encoder> void reflect_fields(Encoder& reflect) const;
 //
+//  The fields are also described at compile time by reflect::fields<T>.
+//
 //  EXAMPLE:
 //
 //      struct foo {
@@ -351,6 +554,10 @@ namespace reflect {
     template<typename> friend struct ::reflect::encode; \
     template<typename Encoder> void reflect_fields(Encoder& reflect) const { \
         MAP(reflect_field_to_encoder, __VA_ARGS__) \
+    } \
+    template<typename> friend struct ::reflect::fields; \
+    template<typename Self> static constexpr auto reflect_field_descriptors() { \
+        return std::make_tuple(MAP_LIST(reflect_field_descriptor, __VA_ARGS__)); \
     }
 
 #define reflect_field_definition(params) reflect_field_definition_ params
@@ -360,4 +567,9 @@ namespace reflect {
 #define reflect_field_to_decoder_(T, name) reflect(#name,name);
 
 #define reflect_field_to_encoder(params) reflect_field_to_encoder_ params
-#define reflect_field_to_encoder_(T, name) reflect(#name,name);
\ No newline at end of file
+#define reflect_field_to_encoder_(T, name) \
+    reflect(::reflect::field_name(#name,"\"" #name "\":"),name);
+
+#define reflect_field_descriptor(params) reflect_field_descriptor_ params
+#define reflect_field_descriptor_(T, name) \
+    ::reflect::field<Self,decltype(Self::name)>{#name,&Self::name}
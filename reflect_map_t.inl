@@ -2,40 +2,71 @@
 #warning "reflect_map_t undefined"
 #else
 
-    reflect_decode_template((typename K,typename T),(reflect_map_t<K,T>)) {
-        reflect::substring s;
-        if constexpr(is_string_v<K>) {
-            T v;
-            while (reflect(&s,v)) {
-                value[K(s)]=v;
-            }
-        } else {
-            K k; T v;
-            std::stringstream ss;
-            while (reflect(&s,v)) {
-                ss.seekg(0);
-                ss.seekp(0);
-                ss << s;
-                ss >> k;
-                value[k]=v;
+    reflect_decode_template((typename K,typename T,typename... A),(reflect_map_t<K,T,A...>)) {
+        using map_type = reflect_map_t<K,T,A...>;
+        const auto allocator = value.get_allocator();
+        reserve_hinted(reflect,value);
+        for (reflect::substring s; reflect(&s);) {
+            if constexpr(is_string_v<K>) {
+                if constexpr(has_transparent_lookup_v<map_type>) {
+                    const auto itr = value.find(std::string_view(s.data(),s.size()));
+                    if (itr != value.end()) {
+                        reflect(itr->second);
+                        continue;
+                    }
+                }
+                reflect(value.try_emplace(K(s.begin(),s.size(),allocator)).first->second);
+            } else {
+                K k {};
+                bool parsed = false;
+                if constexpr(std::is_integral_v<K>
+                             and not is_boolean_v<K>
+                             and not is_character_v<K>) {
+                    const auto result = std::from_chars(s.begin(),s.end(),k);
+                    parsed = result.ec == std::errc() and result.ptr == s.end();
+                } else if constexpr(std::is_floating_point_v<K>) {
+                    char buffer[64] {0};
+                    const size_t n = std::min(s.size(),sizeof(buffer)-1);
+                    std::copy(s.begin(),s.begin()+n,buffer);
+                    char* end = nullptr;
+                    k = K(strtold(buffer,&end));
+                    parsed = n and end == buffer + n;
+                } else {
+                    std::stringstream ss(std::string(s.begin(),s.end()));
+                    parsed = bool(ss >> k);
+                }
+                if (parsed) {
+                    reflect(value.try_emplace(std::move(k)).first->second);
+                } else {
+                    T unused = make_using_allocator<T>(allocator);
+                    reflect(unused);
+                }
             }
         }
     }
 
-    reflect_encode_template((typename K,typename T),(reflect_map_t<K,T>)) {
+    reflect_encode_template((typename K,typename T,typename... A),(reflect_map_t<K,T,A...>)) {
         if constexpr(is_string_v<K>) {
             for (auto& pair : value) {
                 reflect(pair.first,pair.second);
             }
+        } else if constexpr(std::is_integral_v<K>
+                            and not is_boolean_v<K>
+                            and not is_character_v<K>) {
+            char buffer[32];
+            for (auto& pair : value) {
+                const auto result = std::to_chars(buffer,buffer+sizeof(buffer),pair.first);
+                reflect(reflect::substring(buffer,size_t(result.ptr-buffer)),pair.second);
+            }
         } else {
             std::stringstream ss;
             for (auto& pair : value) {
-                ss.seekg(0);
-                ss.seekp(0);
+                ss.str(std::string());
+                ss.clear();
                 ss << pair.first;
                 reflect(ss.str(),pair.second);
             }
         }
     }
 
-#endif
\ No newline at end of file
+#endif
@@ -5,7 +5,8 @@
     reflect_is_array_template((typename T,class A),(reflect_vector_t<T,A>));
 
     reflect_decode_template((typename T,class A),(reflect_vector_t<T,A>)) {
-        for (T t; reflect(t);) {
+        reserve_hinted(reflect,value);
+        for (T t = make_using_allocator<T>(value.get_allocator()); reflect(t);) {
             value.emplace_back(std::move(t));
         }
     }
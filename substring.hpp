@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -19,7 +21,7 @@ namespace reflect {
 
         substring(decltype(nullptr)) {}
 
-        substring(const char* s, size_t len)
+        constexpr substring(const char* s, size_t len)
         : _head(s?s:""), _size(s?len:0) {}
 
         template<size_t SIZE>
@@ -29,7 +31,8 @@ namespace reflect {
         substring(const char* s)
         : substring(s, s ? strlen(s) : 0) {}
 
-        substring(const std::string& s)
+        template<typename Traits, typename Allocator>
+        substring(const std::basic_string<char,Traits,Allocator>& s)
         : substring(s.c_str(), s.length()) {}
 
         substring(const_t& src) = default;
@@ -100,18 +103,107 @@ namespace reflect {
 
     //--------------------------------------------------------------------------
 
-   std::ostream& operator << (std::ostream& o, const substring& s) {
-       o.write(s.begin(), s.size());
-       return o;
-   }
+    inline
+    std::ostream& operator << (std::ostream& o, const substring& s) {
+        o.write(s.begin(), s.size());
+        return o;
+    }
 
     //--------------------------------------------------------------------------
+    //  hash64(data,size,seed)
+    //
+    //  A fast non-cryptographic hash of size bytes, after wyhash.  Bytes are
+    //  read in native order, so hashes are not portable between platforms
+    //  of different endianness.
+
+    namespace wyhash {
+
+        // the low and high halves of the 128-bit product of a and b
+        inline void mum(uint64_t& a, uint64_t& b) {
+            #if defined(__SIZEOF_INT128__)
+            const __uint128_t r = __uint128_t(a) * b;
+            a = uint64_t(r);
+            b = uint64_t(r >> 64);
+            #else
+            const uint64_t ha = a >> 32, hb = b >> 32;
+            const uint64_t la = uint32_t(a), lb = uint32_t(b);
+            const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            const uint64_t t = rl + (rm0 << 32);
+            const uint64_t lo = t + (rm1 << 32);
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+            a = lo;
+            #endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b) {
+            mum(a,b);
+            return a ^ b;
+        }
 
-    // inline
-    // size_t
-    // substring::hash(uint32_t seed) const {
-    //     return _size ? size_t(hash64(_head, _size, seed)) : 0;
-    // }
+        inline uint64_t r8(const uint8_t* p) {
+            uint64_t v; memcpy(&v,p,8); return v;
+        }
+
+        inline uint64_t r4(const uint8_t* p) {
+            uint32_t v; memcpy(&v,p,4); return v;
+        }
+
+        inline uint64_t r3(const uint8_t* p, size_t k) {
+            return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+        }
+
+        static constexpr uint64_t p0 = 0x2d358dccaa6c78a5ull;
+        static constexpr uint64_t p1 = 0x8bb84b93962eacc9ull;
+        static constexpr uint64_t p2 = 0x4b33a62ed433d4a3ull;
+        static constexpr uint64_t p3 = 0x4d5a2da51de1aa47ull;
+
+    } // namespace wyhash
+
+    inline
+    uint64_t
+    hash64(const void* data, size_t size, uint64_t seed = 0) {
+        using namespace wyhash;
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        seed ^= mix(seed ^ p0, p1);
+        uint64_t a = 0, b = 0;
+        if (size <= 16) {
+            if (size >= 4) {
+                const size_t q = (size >> 3) << 2;
+                a = (r4(p) << 32) | r4(p + q);
+                b = (r4(p + size - 4) << 32) | r4(p + size - 4 - q);
+            } else if (size > 0) {
+                a = r3(p,size);
+            }
+        } else {
+            size_t i = size;
+            if (i >= 48) {
+                uint64_t see1 = seed, see2 = seed;
+                do {
+                    seed = mix(r8(p) ^ p1, r8(p + 8) ^ seed);
+                    see1 = mix(r8(p + 16) ^ p2, r8(p + 24) ^ see1);
+                    see2 = mix(r8(p + 32) ^ p3, r8(p + 40) ^ see2);
+                    p += 48; i -= 48;
+                } while (i >= 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16) {
+                seed = mix(r8(p) ^ p1, r8(p + 8) ^ seed);
+                p += 16; i -= 16;
+            }
+            a = r8(p + i - 16);
+            b = r8(p + i - 8);
+        }
+        a ^= p1;
+        b ^= seed;
+        mum(a,b);
+        return mix(a ^ p0 ^ size, b ^ p1);
+    }
+
+    inline
+    size_t
+    substring::hash(uint32_t seed) const {
+        return size_t(hash64(_head, _size, seed));
+    }
 
     //--------------------------------------------------------------------------
 
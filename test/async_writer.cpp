@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+//  async_writer: output is identical to writing synchronously, full buffers
+//  apply backpressure, errors and destruction flush correctly.  Run with
+//  SANITIZE=thread to check the hand-off between threads.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/async_writer.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct item {
+    reflect_fields(
+        ((std::string),name),
+        ((std::vector<int>),values),
+        ((long),id))
+};
+
+// a target much slower than encoding, so that buffers back up
+struct slow_writer final : reflect::writer {
+    std::string out;
+    explicit operator bool() const override { return true; }
+    size_t offset() const override { return out.size(); }
+    void write(const char* s, size_t n) override {
+        out.append(s,n);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+};
+
+// a target which fails after limit bytes
+struct failing_writer final : reflect::writer {
+    size_t size = 0, limit = 0;
+    explicit operator bool() const override { return size < limit; }
+    size_t offset() const override { return size; }
+    void write(const char*, size_t n) override { size += n; }
+};
+
+static std::vector<item> items() {
+    std::vector<item> items(5000);
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = {"item " + std::to_string(i),{int(i),int(i*2)},long(i)};
+    }
+    return items;
+}
+
+static void encode(reflect::writer& writer, const std::vector<item>& items) {
+    json::encoder encoder(writer);
+    for (auto& i : items) {
+        encoder.reset(writer);
+        encoder(i);
+        writer.write('\n');
+    }
+}
+
+int main() {
+    const auto input = items();
+    std::vector<char> expected;
+    reflect::vector_writer expected_writer(expected);
+    encode(expected_writer,input);
+    const std::string want(expected.begin(),expected.end());
+
+    {   // identical output, with backpressure from a slow target
+        slow_writer target;
+        reflect::async_writer writer(target,4096);
+        encode(writer,input);
+        check(writer.offset() == want.size());
+        check(writer.flush());
+        check(target.out == want);
+        check(writer.stalls() > 0);
+    }
+
+    {   // flushed on destruction, with more than two buffers
+        slow_writer target;
+        {
+            reflect::async_writer writer(target,1000,4);
+            encode(writer,input);
+        }
+        check(target.out == want);
+    }
+
+    {   // submit() hands off without waiting, flush() waits
+        slow_writer target;
+        reflect::async_writer writer(target);
+        writer.write("abc",3);
+        writer.submit();
+        check(writer.flush());
+        check(target.out == "abc");
+    }
+
+    {   // a failing target makes the writer false
+        failing_writer target;
+        target.limit = 10000;
+        reflect::async_writer writer(target,4096);
+        encode(writer,input);
+        check(not writer.flush());
+        check(not writer);
+    }
+
+    return check_result("async_writer");
+}
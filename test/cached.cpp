@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------
+//  cached: documents with cached values encode as their plain equivalents
+//  do, after changes at any depth, in any context, and from several threads
+//  at once.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct route {
+    reflect_fields(
+        ((std::string),path),
+        ((int),weight))
+};
+
+struct route_table {
+    reflect_fields(
+        ((std::vector<reflect::cached<route>>),list))
+};
+
+struct limit_set {
+    reflect_fields(
+        ((int),connections),
+        ((double),rate))
+};
+
+struct config {
+    reflect_fields(
+        ((reflect::cached<route_table>),routes),
+        ((reflect::cached<limit_set>),limits),
+        ((int),version))
+};
+
+// the same document without caching
+struct plain_routes {
+    reflect_fields(
+        ((std::vector<route>),list))
+};
+
+struct plain_config {
+    reflect_fields(
+        ((plain_routes),routes),
+        ((limit_set),limits),
+        ((int),version))
+};
+
+static plain_config plain(const config& c) {
+    plain_config p;
+    for (const auto& r : c.routes->list) p.routes.list.push_back(*r);
+    p.limits = *c.limits;
+    p.version = c.version;
+    return p;
+}
+
+template<typename T>
+static std::string encode(const T& value, json::preferences prefs = {}) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer,prefs);
+    encoder(value);
+    return std::string(out.begin(),out.end());
+}
+
+static bool same(const config& c, json::preferences prefs = {}) {
+    return encode(c,prefs) == encode(plain(c),prefs);
+}
+
+int main() {
+    config c {};
+    c.version = 1;
+    c.limits.edit() = {100,1.5};
+    for (int i = 0; i < 100; ++i) {
+        c.routes.edit().list.push_back(route{"/r/" + std::to_string(i),i%7});
+    }
+    check(same(c));
+    check(same(c));
+
+    // changes through the enclosing value, the nested one, or in place
+    c.limits.edit().connections = 512;
+    check(same(c));
+    c.routes.edit().list[5].edit().weight = 99;
+    check(same(c));
+    auto& nested = const_cast<reflect::cached<route>&>(c.routes->list[7]);
+    nested.edit().path = "/changed";
+    check(same(c));
+    const_cast<route&>(*c.routes->list[8]).weight = -1;
+    const_cast<reflect::cached<route>&>(c.routes->list[8]).touch();
+    check(same(c));
+
+    // other contexts
+    const json::preferences pretty(": ",",","  ","\n");
+    check(same(c,pretty));
+    check(same(c,pretty));
+    check(same(c));
+
+    // copies start without a cache, moves take theirs along
+    config d = c;
+    d.limits.edit().rate = 2;
+    check(same(d));
+    check(same(c));
+    config e = std::move(d);
+    e.routes.edit().list[1].edit().weight = 3;
+    check(same(e));
+
+    // decoding changes through edit()
+    reflect::string_reader reader(R"({"limits":{"rate":9.5}})");
+    json::decoder decoder(reader);
+    check(decoder(c) and not decoder.error());
+    check(c.limits->rate == 9.5);
+    check(same(c));
+
+    // a const document encoded by several threads, with invalid caches and
+    // in contexts which differ by depth
+    c.routes.edit().list[2].edit().weight = 5;
+    std::vector<config> documents(1);
+    documents[0] = std::move(c);
+    const std::string expected[] = {
+        encode(plain(documents[0])),
+        encode(std::vector<plain_config>{plain(documents[0])}),
+    };
+    documents[0].routes.touch();
+    bool consistent[8] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&,t]{
+            consistent[t] = true;
+            for (int i = 0; i < 50; ++i) {
+                consistent[t] &= (t % 2)
+                    ? encode(documents) == expected[1]
+                    : encode(documents[0]) == expected[0];
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (bool c : consistent) check(c);
+
+    return check_result("cached");
+}
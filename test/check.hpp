@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdio>
+
+//------------------------------------------------------------------------------
+//  check(expr)
+//
+//  Reports a failed expectation with its location and keeps going, so that a
+//  test reports every failure in one run.  Each test's main() returns
+//  check_result(), which prints a summary and is nonzero after a failure.
+//
+namespace check_detail {
+    inline int checks = 0;
+    inline int failures = 0;
+}
+
+#define check(expr) ((void)(                                                  \
+    ++check_detail::checks,                                                   \
+    (expr) ? 0 : (++check_detail::failures,                                   \
+        std::fprintf(stderr,"%s:%d: check failed: %s\n",                      \
+                     __FILE__,__LINE__,#expr))))
+
+inline int check_result(const char* name) {
+    std::printf("%-16s %d checks, %d failed\n",
+                name,check_detail::checks,check_detail::failures);
+    return check_detail::failures != 0;
+}
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+//  compare: equal() agrees with diff(), whether or not the memcmp shortcut
+//  applies, and diff() reports the JSON Pointer of each change.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/compare.hpp>
+#include <cmath>
+#include <string>
+#include "check.hpp"
+
+// a reflected field and an unreflected one
+struct cache {
+    reflect_fields(
+        ((int),a))
+    int cache_ = 0;
+};
+
+struct nested {
+    reflect_fields(
+        ((cache),c))
+};
+
+// a single field, whose fold must compile without warnings
+struct single {
+    reflect_fields(
+        ((double),x))
+};
+
+struct ints {
+    reflect_fields(
+        ((int),a),
+        ((int),b))
+};
+
+struct vec2 { float x,y; };
+
+reflect_type((vec2)) {
+    reflect("x",value.x);
+    reflect("y",value.y);
+}
+
+struct record {
+    reflect_fields(
+        ((int),i),
+        ((std::vector<ints>),v),
+        ((vec2),p),
+        ((std::map<std::string,int>),m),
+        ((std::map<char,int>),c),
+        ((double),f))
+};
+
+template<typename T>
+static std::string paths(const T& a, const T& b) {
+    std::string s;
+    for (const auto& path : reflect::diff(a,b)) s += path + " ";
+    return s;
+}
+
+int main() {
+    // unreflected members are ignored
+    cache a {1,2}, b {1,3};
+    check(reflect::equal(a,b));
+    check(reflect::diff(a,b).empty());
+    check(reflect::equal(nested{a},nested{b}));
+    check(reflect::equal(std::vector<cache>{a},std::vector<cache>{b}));
+    b.a = 2;
+    check(not reflect::equal(a,b));
+    check(paths(a,b) == "/a ");
+
+    check(reflect::equal(single{0.5},single{0.5}));
+    check(reflect::equal(single{0.0},single{-0.0}));
+    check(not reflect::equal(single{0.5},single{1.5}));
+    check(reflect::equal(single{NAN},single{NAN}));
+
+    check(reflect::equal(ints{1,2},ints{1,2}));
+    check(not reflect::equal(ints{1,2},ints{1,3}));
+    check(not reflect::equal(std::vector<ints>{{1,2}},std::vector<ints>{{1,3}}));
+
+    record r {};
+    r.i = 1;
+    r.v = {{1,2},{3,4}};
+    r.p = {1,2};
+    r.m = {{"a/b",1},{"c~d",2}};
+    r.c = {{'x',1}};
+    r.f = 0.5;
+    record s = r;
+    check(reflect::equal(r,s));
+    s.v[1].b = 5;
+    s.p.y = 3;
+    s.m["a/b"] = 0;
+    s.m.erase("c~d");
+    s.c['x'] = 2;
+    check(not reflect::equal(r,s));
+    check(paths(r,s) == "/v/1/b /p/y /m/a~1b /m/c~0d /c/x ");
+
+    return check_result("compare");
+}
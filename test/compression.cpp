@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+//  compression: NDJSON encoded through a compressing_writer decodes, and
+//  reads back byte for byte, through a decompressing_reader, in each format
+//  whose library is available, and truncated or corrupted input is reported.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/compression.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+namespace compression = reflect::compression;
+
+struct record {
+    reflect_fields(
+        ((std::string),name),
+        ((std::vector<double>),v),
+        ((long),id))
+
+    bool operator==(const record& r) const {
+        return name == r.name and v == r.v and id == r.id;
+    }
+};
+
+static std::vector<record> records;
+
+//  Encodes the records one per line, into writer.
+static void encode(reflect::writer& writer) {
+    json::encoder encoder(writer);
+    for (const record& r : records) {
+        encoder.reset(writer);
+        encoder(r);
+        writer.write('\n');
+    }
+}
+
+template<typename Format>
+static void test() {
+    std::vector<char> plain;
+    reflect::vector_writer plain_writer(plain);
+    encode(plain_writer);
+
+    // compressed in several streams and flushed part way
+    std::vector<char> packed;
+    {
+        reflect::vector_writer target(packed);
+        reflect::compressing_writer<Format> writer(target);
+        json::encoder encoder(writer);
+        for (size_t i = 0; i < records.size(); ++i) {
+            encoder.reset(writer);
+            encoder(records[i]);
+            writer.write('\n');
+            if (i == 10) check(writer.flush());
+            if (i == records.size()/2) check(writer.finish());
+        }
+        check(writer.offset() == plain.size());
+        check(writer);
+    }
+    check(packed.size() < plain.size()/2);
+    const std::string compressed(packed.begin(),packed.end());
+
+    // decoded record by record
+    {
+        reflect::string_reader source(compressed);
+        reflect::decompressing_reader<Format> reader(source);
+        json::decoder decoder(reader);
+        size_t n = 0;
+        for (record r; n < records.size() and decoder(r); decoder.reset()) {
+            if (not (r == records[n])) break;
+            r = record();
+            ++n;
+        }
+        check(n == records.size());
+        check(not reader.error());
+    }
+
+    // read byte for byte through a stream, with small blocks
+    {
+        std::istringstream stream(compressed);
+        reflect::stream_reader source(stream);
+        reflect::decompressing_reader<Format> reader(source,1000,777);
+        std::string out;
+        while (reader) out += reader.read();
+        check(out == std::string(plain.begin(),plain.end()));
+        check(not reader.error());
+    }
+
+    // seeking, views, size and locations
+    {
+        reflect::string_reader source(compressed);
+        reflect::decompressing_reader<Format> reader(source,100,4096);
+        reader.seek(plain.size()/2);
+        check(reader.peek() == plain[plain.size()/2]);
+        reader.seek(10);
+        check(reader.read() == plain[10]);
+        check(reader.size() == plain.size());
+        check(reader.offset() == 11);
+        const auto view = reader.view(11,5);
+        check(view.size() == 5 and memcmp(view.data(),plain.data()+11,5) == 0);
+        size_t line = 0, column = 0;
+        reader.locate(plain.size()-1,line,column);
+        check(line == records.size());
+    }
+
+    // truncated
+    {
+        const std::string truncated = compressed.substr(0,compressed.size()-3);
+        reflect::string_reader source(truncated);
+        reflect::decompressing_reader<Format> reader(source);
+        while (reader) reader.read();
+        check(reader.error());
+    }
+
+    // corrupted
+    {
+        std::string corrupted = compressed;
+        corrupted[corrupted.size()/3] ^= 0x55;
+        corrupted[corrupted.size()/3+1] ^= 0x55;
+        reflect::string_reader source(corrupted);
+        reflect::decompressing_reader<Format> reader(source);
+        while (reader) reader.read();
+        check(reader.error());
+    }
+}
+
+int main() {
+    records.resize(20000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i] = {"record " + std::to_string(i % 1000),
+            {double(i % 7),1.5,double(i)*0.5},long(i)};
+    }
+
+    #if reflect_compression_zlib
+    test<compression::zlib>();
+    test<compression::gzip>();
+    #endif
+    #if reflect_compression_zstd
+    test<compression::zstd>();
+    #endif
+    #if reflect_compression_lz4
+    test<compression::lz4>();
+    #endif
+
+    return check_result("compression");
+}
@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------
+//  each: elements are decoded one at a time into a fresh instance, from any
+//  reader, and the range ends at the first error.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/each.hpp>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct record {
+    reflect_fields(
+        ((int),a),
+        ((std::string),s),
+        ((std::vector<int>),v))
+};
+
+template<typename Each>
+static std::vector<record> collect(Each& records) {
+    std::vector<record> out;
+    for (auto& r : records) {
+        out.push_back(r);
+    }
+    return out;
+}
+
+int main() {
+    {   // fields absent from an element are not left over from the last one
+        const std::string in =
+            R"([{"a":1,"v":[1]},{"s":"y"},{"a":3,"v":[2]}])";
+        reflect::string_reader reader(in);
+        json::each<record> records(reader);
+        const auto out = collect(records);
+        check(out.size() == 3 and not records.error());
+        check(out[0].a == 1 and out[0].s.empty() and out[0].v == std::vector<int>({1}));
+        check(out[1].a == 0 and out[1].s == "y" and out[1].v.empty());
+        check(out[2].a == 3 and out[2].s.empty() and out[2].v == std::vector<int>({2}));
+    }
+
+    {   // containers are cleared between elements rather than appended to
+        const std::string in = "[[1,2],[],[3]]";
+        reflect::string_reader reader(in);
+        std::vector<std::vector<int>> out;
+        for (auto& v : json::each<std::vector<int>>(reader)) {
+            out.push_back(v);
+        }
+        check(out == std::vector<std::vector<int>>({{1,2},{},{3}}));
+    }
+
+    {   // a nested array is visited after positioning the decoder on it
+        const std::string in = R"({"meta":{"n":2},"items":[{"a":1},{"a":2}]})";
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        check(decoder.parse_object_head() and decoder.seek_property("items"));
+        json::each<record> records(decoder);
+        const auto out = collect(records);
+        check(out.size() == 2 and out[0].a == 1 and out[1].a == 2);
+        check(not records.error());
+    }
+
+    {   // an error mid-array ends the range and is reported
+        const std::string in = R"([{"a":1},{"a":2,},{"a":3}])";
+        reflect::string_reader reader(in);
+        json::basic_decoder<json::syntax::rfc8259> decoder(reader);
+        json::each<record,json::basic_decoder<json::syntax::rfc8259>> records(decoder);
+        const auto out = collect(records);
+        check(out.size() == 1 and out[0].a == 1);
+        check(records.error());
+    }
+
+    {   // streams are decoded as they are read
+        std::istringstream stream(R"([{"a":1,"s":"x"}, {"a":2}])");
+        reflect::stream_reader reader(stream);
+        json::each<record> records(reader);
+        const auto out = collect(records);
+        check(out.size() == 2 and not records.error());
+        check(out[0].a == 1 and out[0].s == "x");
+        check(out[1].a == 2 and out[1].s.empty());
+    }
+
+    {   // an empty array yields nothing
+        const std::string in = "[]";
+        reflect::string_reader reader(in);
+        json::each<record> records(reader);
+        check(collect(records).empty() and not records.error());
+    }
+
+    return check_result("each");
+}
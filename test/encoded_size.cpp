@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//  encoded_size: measuring agrees with encoding under any preferences, and a
+//  buffer_writer sized by it holds the output exactly, while a smaller one
+//  stops at the first write which does not fit.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/cached.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct sample {
+    reflect_fields(
+        ((std::vector<int64_t>),integers),
+        ((std::vector<uint64_t>),naturals),
+        ((std::vector<double>),reals),
+        ((std::vector<std::string>),strings),
+        ((std::map<std::string,bool>),flags),
+        ((std::vector<std::vector<int>>),nested))
+};
+
+struct wrapper {
+    reflect_fields(
+        ((reflect::cached<sample>),cached),
+        ((sample),plain))
+};
+
+static sample make_sample() {
+    sample s;
+    s.integers = {0,9,10,-1,-10,99,100,std::numeric_limits<int64_t>::min(),
+                  std::numeric_limits<int64_t>::max()};
+    s.naturals = {0,std::numeric_limits<uint64_t>::max()};
+    s.reals = {0.0,-1.5,1e300,3.14159};
+    s.strings = {"","plain","quote\" backslash\\ slash/","\b\f\n\r\t",
+                 std::string("\x01\x1f\0",3),"caf\xc3\xa9"};
+    s.flags = {{"on",true},{"off",false},{"es\"caped",true}};
+    s.nested = {{},{1},{2,3}};
+    return s;
+}
+
+template<typename T>
+static std::string encode(const json::preferences& prefs, const T& value) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer,prefs);
+    encoder(value);
+    return std::string(out.begin(),out.end());
+}
+
+int main() {
+    const json::preferences compact;
+    const json::preferences pretty(": ",",","    ","\n",true,true);
+    const sample s = make_sample();
+    wrapper w;
+    w.cached.edit() = s;
+    w.plain = s;
+
+    {   // measuring matches encoding, for each kind of value and preference
+        for (const auto& prefs : {compact,pretty}) {
+            check(json::encoded_size(prefs,s) == encode(prefs,s).size());
+            check(json::encoded_size(prefs,w) == encode(prefs,w).size());
+            check(json::encoded_size(prefs,s.strings) == encode(prefs,s.strings).size());
+            check(json::encoded_size(prefs,s.integers) == encode(prefs,s.integers).size());
+        }
+        check(encode(pretty,s).size() > encode(compact,s).size());
+    }
+
+    {   // a buffer of the measured size holds the output exactly
+        for (const auto& prefs : {compact,pretty}) {
+            const std::string expected = encode(prefs,w);
+            std::vector<char> frame(json::encoded_size(prefs,w));
+            reflect::buffer_writer writer(frame.data(),frame.size());
+            json::encoder encoder(writer,prefs);
+            encoder(w);
+            check(writer and writer.offset() == frame.size());
+            check(std::string(frame.begin(),frame.end()) == expected);
+        }
+    }
+
+    {   // a smaller buffer keeps what fit, is false from then on, and is
+        // never written beyond its end
+        const std::string expected = encode(compact,s);
+        for (const size_t size : {size_t(0),size_t(1),size_t(17),expected.size()-1}) {
+            std::vector<char> frame(size + 8,'#');
+            reflect::buffer_writer writer(frame.data(),size);
+            json::encoder encoder(writer,compact);
+            encoder(s);
+            check(not writer);
+            check(writer.offset() <= size);
+            check(expected.compare(0,writer.offset(),frame.data(),writer.offset()) == 0);
+            check(std::string(frame.end()-8,frame.end()) == "########");
+            const size_t offset = writer.offset();
+            writer.write("x",1);
+            check(writer.offset() == offset and not writer);
+        }
+    }
+
+    {   // a default constructed buffer_writer is false and holds nothing
+        reflect::buffer_writer writer;
+        check(not writer and writer.offset() == 0);
+    }
+
+    return check_result("encoded_size");
+}
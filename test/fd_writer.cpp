@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+//  fd_writer: output written through a pipe, with small and borrowed writes
+//  interleaved across flushes, arrives whole and in order, and errors are
+//  kept rather than lost.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/cached.hpp>
+#include <reflect/fd_writer.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct blob {
+    reflect_fields(
+        ((std::string),name),
+        ((std::string),data))
+};
+
+struct document {
+    reflect_fields(
+        ((std::vector<blob>),blobs),
+        ((reflect::cached<blob>),big),
+        ((int),n))
+};
+
+static std::string encode(const document& d, json::preferences prefs) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer,prefs);
+    encoder(d);
+    return std::string(out.begin(),out.end());
+}
+
+static std::string slurp(int fd) {
+    std::string s;
+    char buffer[65536];
+    ssize_t n;
+    while ((n = read(fd,buffer,sizeof(buffer))) > 0) s.append(buffer,size_t(n));
+    return s;
+}
+
+int main() {
+    signal(SIGPIPE,SIG_IGN);
+
+    document d {};
+    for (int i = 0; i < 3000; ++i) {
+        const size_t size = (i % 5 == 0) ? 4000 : 20;
+        d.blobs.push_back({"blob" + std::to_string(i),
+            std::string(size,char('a' + i % 26)) + "\"q\""});
+    }
+    d.big.edit() = {"big",std::string(1 << 20,'z')};
+    d.n = 7;
+
+    for (bool borrow : {false,true}) {
+        json::preferences prefs;
+        prefs.borrow_strings = borrow;
+        const std::string expected = encode(d,prefs);
+        int fds[2];
+        check(pipe(fds) == 0);
+        std::string received;
+        std::thread reader([&]{ received = slurp(fds[0]); });
+        size_t offset = 0;
+        {
+            // few fragments and a small buffer, to flush often
+            reflect::fd_writer writer(fds[1],64,4096);
+            json::encoder encoder(writer,prefs);
+            encoder(d);
+            offset = writer.offset();
+            encoder.reset(writer);
+            encoder(d);
+            writer.flush();
+            check(writer);
+            check(writer.error() == 0);
+        }
+        close(fds[1]);
+        reader.join();
+        close(fds[0]);
+        check(offset == expected.size());
+        check(received == expected + expected);
+    }
+
+    // an invalid descriptor
+    {
+        reflect::fd_writer writer(-1);
+        json::encoder encoder(writer);
+        encoder(d);
+        check(not writer);
+        check(not writer.flush());
+        check(writer.offset() == 0);
+    }
+
+    // a pipe closed by its reader
+    {
+        int fds[2];
+        check(pipe(fds) == 0);
+        close(fds[0]);
+        reflect::fd_writer writer(fds[1]);
+        json::encoder encoder(writer);
+        encoder(d);
+        writer.flush();
+        check(not writer);
+        check(writer.error() == EPIPE);
+        close(fds[1]);
+    }
+
+    return check_result("fd_writer");
+}
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//  field_name: fields encode with the preferred colon, as the same keys do
+//  when passed as plain strings, so the precomputed "name": is only written
+//  where the colon is the default.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/cached.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct inner {
+    reflect_fields(
+        ((int),a),
+        ((std::vector<int>),b))
+};
+
+struct outer {
+    reflect_fields(
+        ((inner),first),
+        ((reflect::cached<inner>),second),
+        ((std::string),name))
+};
+
+// the same documents, keyed by strings rather than field names
+struct plain_inner { int a; std::vector<int> b; };
+
+reflect_type((plain_inner)) {
+    reflect("a",value.a);
+    reflect("b",value.b);
+}
+
+struct plain_outer {
+    plain_inner first;
+    reflect::cached<plain_inner> second;
+    std::string name;
+};
+
+reflect_type((plain_outer)) {
+    reflect("first",value.first);
+    reflect("second",value.second);
+    reflect("name",value.name);
+}
+
+template<typename T>
+static std::string encode(const json::preferences& prefs, const T& value) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer,prefs);
+    encoder(value);
+    return std::string(out.begin(),out.end());
+}
+
+static size_t count(const std::string& s, const char* part) {
+    size_t n = 0;
+    for (size_t at = s.find(part); at != std::string::npos; at = s.find(part,at+1)) {
+        n += 1;
+    }
+    return n;
+}
+
+int main() {
+    outer o;
+    o.first = {1,{2,3}};
+    o.second.edit() = {4,{5}};
+    o.name = "x";
+
+    plain_outer p;
+    p.first = {1,{2,3}};
+    p.second.edit() = {4,{5}};
+    p.name = "x";
+
+    const json::preferences prefs[] = {
+        json::preferences(),
+        json::preferences(": "),
+        json::preferences(" : ",", "),
+        json::preferences(""),
+        json::preferences(nullptr),
+        json::preferences(": ",",","  ","\n",true,true),
+    };
+
+    {   // each preference writes fields as it writes string keys
+        for (const auto& pref : prefs) {
+            check(encode(pref,o) == encode(pref,p));
+        }
+    }
+
+    {   // examples, encoding the cached value under each preference in turn
+        check(encode(prefs[0],o) ==
+              R"({"first":{"a":1,"b":[2,3]},"second":{"a":4,"b":[5]},"name":"x"})");
+        check(encode(prefs[1],o) ==
+              R"({"first": {"a": 1,"b": [2,3]},"second": {"a": 4,"b": [5]},"name": "x"})");
+        check(encode(prefs[3],o) ==
+              R"({"first"{"a"1,"b"[2,3]},"second"{"a"4,"b"[5]},"name""x"})");
+        check(encode(prefs[4],o) == encode(prefs[3],o));
+        check(encode(prefs[0],o) ==
+              R"({"first":{"a":1,"b":[2,3]},"second":{"a":4,"b":[5]},"name":"x"})");
+        const std::string pretty = encode(prefs[5],o);
+        check(pretty.find("\"second\": {\n") != std::string::npos);
+        check(pretty.find("\"a\": 4,\n") != std::string::npos);
+        check(count(pretty,"\":") == 7 and count(pretty,"\": ") == 7);
+    }
+
+    return check_result("field_name");
+}
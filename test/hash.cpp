@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+//  hash: values which reflect::equal() considers equal hash equally, and
+//  values which differ anywhere hash differently.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/compare.hpp>
+#include <reflect/hash.hpp>
+#include <cmath>
+#include <limits>
+#include <string>
+#include "check.hpp"
+
+struct inner {
+    reflect_fields(
+        ((std::string),s),
+        ((std::vector<double>),d))
+};
+
+struct vec2 { float x,y; };
+
+reflect_type((vec2)) {
+    reflect("x",value.x);
+    reflect("y",value.y);
+}
+
+struct outer {
+    reflect_fields(
+        ((int),i),
+        ((std::vector<inner>),v),
+        ((vec2),p),
+        ((std::unordered_map<std::string,int>),u),
+        ((std::map<int,std::string>),m),
+        ((long double),ld))
+};
+
+template<typename T>
+static bool same(const T& a, const T& b) {
+    return reflect::equal(a,b) and reflect::hash(a) == reflect::hash(b);
+}
+
+template<typename T>
+static bool different(const T& a, const T& b) {
+    return not reflect::equal(a,b) and reflect::hash(a) != reflect::hash(b);
+}
+
+int main() {
+    outer a {};
+    a.i = 1;
+    a.v.resize(2);
+    a.v[0].s = "hello";
+    a.v[1].d = {1,2,3};
+    a.p = {1,2};
+    a.ld = 1.5;
+    a.m = {{1,"x"},{2,"y"}};
+    for (int i = 0; i < 100; ++i) a.u["k" + std::to_string(i)] = i;
+
+    // unordered maps hash alike whatever their iteration order
+    outer b = a;
+    b.u.clear();
+    b.u.rehash(1000);
+    for (int i = 99; i >= 0; --i) b.u["k" + std::to_string(i)] = i;
+    check(same(a,b));
+
+    b = a; b.v[1].d[2] = 4; check(different(a,b));
+    b = a; b.v[0].s = "hellp"; check(different(a,b));
+    b = a; b.m[3] = "z"; check(different(a,b));
+    b = a; b.p.y = 3; check(different(a,b));
+    b = a; b.u["k0"] = 1; check(different(a,b));
+    check(reflect::hash(a,1) != reflect::hash(a));
+
+    // zeros of either sign are equal
+    check(same(0.0,-0.0));
+    check(same(0.0f,-0.0f));
+    check(same(0.0L,-0.0L));
+    b = a; b.p.x = 0; a.p.x = -0.0f; check(same(a,b));
+    b = a; b.v[1].d[0] = 0; a.v[1].d[0] = -0.0; check(same(a,b));
+
+    // every NaN hashes alike, so a NaN hashes as the same NaN does
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    check(same(nan,nan));
+    check(reflect::hash(nan) == reflect::hash(-nan));
+    check(reflect::hash(nan) == reflect::hash(std::nan("1")));
+    check(reflect::hash(nan) != reflect::hash(0.0));
+
+    return check_result("hash");
+}
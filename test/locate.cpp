@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+//  locate: readers agree on the line and column of every offset, whether the
+//  input is contiguous or streamed, and whether or not the stream has ended.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct location { size_t line, column; };
+
+static location locate(const reflect::reader& reader, size_t offset) {
+    location l {0,0};
+    reader.locate(offset,l.line,l.column);
+    return l;
+}
+
+// computes the location of each offset the slow way
+static location expected(const std::string& in, size_t offset) {
+    location l {1,0};
+    for (size_t i = 0; i < offset; ++i) {
+        l.column = in[i] == '\n' ? 0 : l.column + 1;
+        l.line += in[i] == '\n';
+    }
+    return l;
+}
+
+static bool same(location a, location b) {
+    return a.line == b.line and a.column == b.column;
+}
+
+template<typename Reader>
+static reflect::read_error decode_error(Reader& reader) {
+    json::basic_decoder<json::syntax::rfc8259> decoder(reader);
+    std::vector<int> unused;
+    decoder(unused);
+    return decoder.error();
+}
+
+int main() {
+    // lines of varying length, spanning several of the stream's index blocks
+    std::string in;
+    for (int i = 0; in.size() < 3 * 4096; ++i) {
+        in += std::string(size_t(i % 97),'x') + "\n";
+    }
+
+    {   // in place
+        reflect::string_reader reader(in);
+        bool all = true;
+        for (size_t offset = 0; offset <= in.size(); offset += 37) {
+            all = all and same(locate(reader,offset),expected(in,offset));
+        }
+        check(all);
+        check(same(locate(reader,0),{1,0}));
+        check(same(locate(reader,in.size()),expected(in,in.size())));
+    }
+
+    {   // streamed, partly read
+        std::istringstream stream(in);
+        reflect::stream_reader reader(stream);
+        for (size_t i = 0; i < 5000; ++i) reader.read();
+        bool all = true;
+        for (size_t offset = 0; offset <= in.size(); offset += 37) {
+            all = all and same(locate(reader,offset),expected(in,offset));
+        }
+        check(all);
+        check(reader.offset() == 5000 and reader);
+    }
+
+    {   // streamed, read to the end
+        std::istringstream stream(in);
+        reflect::stream_reader reader(stream);
+        while (reader) reader.read();
+        check(reader.offset() == in.size());
+        bool all = true;
+        for (size_t offset = 0; offset <= in.size(); offset += 37) {
+            all = all and same(locate(reader,offset),expected(in,offset));
+        }
+        check(all);
+        check(same(locate(reader,in.size()),expected(in,in.size())));
+        check(not reader and stream.eof());
+    }
+
+    {   // errors at the end of input are located at the end, not at 1:0
+        const std::string truncated = "[1,\n 2,\n 3";
+        reflect::string_reader string(truncated);
+        const auto a = decode_error(string);
+        std::istringstream stream(truncated);
+        reflect::stream_reader streamed(stream);
+        const auto b = decode_error(streamed);
+        check(a and a.line() == 3);
+        check(b and b.line() == a.line() and b.column() == a.column());
+        check(b.offset() == a.offset());
+    }
+
+    {   // errors within the input are located alike by both readers
+        const std::string bad = "[1,\n 2,\n x]";
+        reflect::string_reader string(bad);
+        const auto a = decode_error(string);
+        std::istringstream stream(bad);
+        reflect::stream_reader streamed(stream);
+        const auto b = decode_error(streamed);
+        check(a and a.line() == 3 and a.column() == 1);
+        check(b and b.line() == 3 and b.column() == 1);
+    }
+
+    return check_result("locate");
+}
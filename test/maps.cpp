@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+//  maps: keys of each kind encode as the stream formatting them did, and
+//  decoding updates existing entries in place.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+template<typename T>
+static std::string encode(const T& value) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer);
+    encoder(value);
+    return std::string(out.begin(),out.end());
+}
+
+template<typename T>
+static bool decode(const std::string& in, T& value) {
+    reflect::string_reader reader(in);
+    json::decoder decoder(reader);
+    return decoder(value) and not decoder.error();
+}
+
+int main() {
+    {   // character keys are characters, as a stream writes them
+        std::map<char,int> m {{'a',1},{'b',2}};
+        check(encode(m) == R"({"a":1,"b":2})");
+        std::map<char,int> d;
+        check(decode(R"({"a":1,"b":2})",d) and d == m);
+        std::map<unsigned char,int> u {{'x',1}};
+        check(encode(u) == R"({"x":1})");
+    }
+
+    {   // integer keys are numbers
+        std::map<int,int> m {{-1,1},{20,2}};
+        check(encode(m) == R"({"-1":1,"20":2})");
+        std::map<int,int> d;
+        check(decode(R"({"-1":1,"20":2,"x":3})",d) and d == m);
+    }
+
+    {   // existing entries are decoded into, others are added
+        std::map<std::string,std::vector<int>,std::less<>> m {{"a",{1}}};
+        check(decode(R"({"a":[2],"b":[3]})",m));
+        check(m["a"] == std::vector<int>({1,2}) and m["b"] == std::vector<int>({3}));
+        std::unordered_map<std::string,std::vector<int>> u {{"a",{1}}};
+        check(decode(R"({"a":[2],"b":[3]})",u));
+        check(u["a"] == std::vector<int>({1,2}) and u["b"] == std::vector<int>({3}));
+    }
+
+    return check_result("maps");
+}
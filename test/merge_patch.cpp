@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+//  merge_patch: the delta between two values, applied onto the first as an
+//  RFC 7386 merge patch, reproduces the second.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/merge_patch.hpp>
+#include <reflect/compare.hpp>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct inner {
+    reflect_fields(
+        ((std::string),s),
+        ((std::vector<double>),d))
+};
+
+struct vec2 { float x,y; };
+
+reflect_type((vec2)) {
+    reflect("x",value.x);
+    reflect("y",value.y);
+}
+
+struct state {
+    reflect_fields(
+        ((int),i),
+        ((std::vector<inner>),v),
+        ((vec2),p),
+        ((std::map<std::string,int>),u),
+        ((std::map<int,inner>),m),
+        ((std::unordered_map<std::string,std::vector<int>>),um),
+        ((inner),in),
+        ((std::string),name))
+};
+
+template<typename T>
+static std::string delta(const T& baseline, const T& current) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer);
+    json::encode_delta(encoder,baseline,current);
+    return std::string(out.begin(),out.end());
+}
+
+template<typename T>
+static bool apply(const std::string& patch, T& target,
+    json::validation validation = json::validation::lenient)
+{
+    reflect::string_reader reader(patch);
+    json::decoder decoder(reader,validation);
+    return json::apply_patch(decoder,target) and not decoder.error();
+}
+
+//  Returns true if the delta from a to b transforms a into b, in either
+//  validation mode.
+static bool round_trip(const state& a, const state& b) {
+    const std::string patch = delta(a,b);
+    state lenient = a, strict = a;
+    return apply(patch,lenient) and reflect::equal(lenient,b)
+       and apply(patch,strict,json::validation::strict)
+       and reflect::equal(strict,b);
+}
+
+int main() {
+    state a {};
+    a.i = 1;
+    a.v.resize(2);
+    a.v[0].s = "x";
+    a.p = {1,2};
+    a.u = {{"a",1},{"b",2}};
+    a.m[1].s = "one";
+    a.m[2].d = {1};
+    a.um = {{"a",{1}},{"b",{2}}};
+    a.in.s = "in";
+    a.name = "n";
+
+    state b = a;
+    check(delta(a,b) == "{}");
+    check(round_trip(a,b));
+
+    b.i = 2;
+    b.p.y = 5;
+    check(delta(a,b) == R"({"i":2,"p":{"y":5}})");
+    check(round_trip(a,b));
+
+    b = a;
+    b.v[1].d = {3,4};
+    b.u.erase("a");
+    b.u["c"] = 3;
+    b.m[2].d.push_back(2);
+    b.m.erase(1);
+    b.m[7].s = "seven";
+    b.um.erase("a");
+    b.um["b"].push_back(3);
+    check(round_trip(a,b));
+
+    b = a; b.in.d = {1,2}; b.name = ""; check(round_trip(a,b));
+    b = a; b.v.clear(); check(round_trip(a,b));
+
+    // external patches with nulls and unknown keys
+    state c = a;
+    check(apply(R"({"name":null,"zzz":{"q":[1,2]},"u":{"a":null,"b":9},)"
+                R"("v":[{"s":"only"}]})",c));
+    check(c.name.empty());
+    check(c.u.size() == 1 and c.u["b"] == 9);
+    check(c.v.size() == 1 and c.v[0].s == "only");
+    check(c.i == 1 and c.in.s == "in");
+
+    // nulls at several depths, by transparent and escaped keys
+    // (qualified, as std::apply is found for arguments from std)
+    using transparent = std::map<std::string,int,std::less<>>;
+    std::map<std::string,transparent,std::less<>> n {
+        {"a",{{"x",1},{"y",2}}},{"b",{{"z",3}}},{"q\"uote",{}}};
+    check(::apply(R"({"a":{"x":null,"w":4},"b":null,"q\"uote":null})",n));
+    check(n.size() == 1 and n["a"] == transparent({{"y",2},{"w",4}}));
+
+    // many nulls, in a map of string keys and one of integer keys
+    std::map<std::string,int> many;
+    std::map<int,int> numbered;
+    std::string nulls = "{", numbered_nulls = "{";
+    for (int i = 0; i < 1000; ++i) {
+        many["k" + std::to_string(i)] = i;
+        numbered[i] = i;
+        if (i % 3) continue;
+        nulls += "\"k" + std::to_string(i) + "\":null,";
+        numbered_nulls += "\"" + std::to_string(i) + "\":null,";
+    }
+    nulls.back() = '}';
+    numbered_nulls.back() = '}';
+    check(::apply(nulls,many) and many.size() == 666 and not many.count("k999"));
+    check(many.count("k998") and many["k998"] == 998);
+    check(::apply(numbered_nulls,numbered) and numbered.size() == 666);
+    check(not numbered.count(0) and numbered.count(1));
+
+    // malformed patches
+    c = a;
+    check(not apply(R"({"i":nul})",c,json::validation::strict));
+    check(not apply("[1]",c));
+
+    return check_result("merge_patch");
+}
@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+//  names: types named like members of namespace reflect can be reflected
+//  with the macros, which specialize reflect's templates from the global
+//  namespace, and reflect_fields() lists its fields in declaration order.
+//
+#include <reflect/cached.hpp>
+#include <reflect/delta.hpp>
+#include <reflect/hash.hpp>
+#include <reflect/pool.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct field { int x; };
+struct cached { int x; };
+struct pool { int x; };
+struct hasher { int x; };
+template<typename T> struct delta { T x; };
+struct fields { int x; };
+
+reflect_type((field)) { reflect("x",value.x); }
+reflect_type((cached)) { reflect("x",value.x); }
+reflect_type((pool)) { reflect("x",value.x); }
+reflect_decode_type((hasher)) { reflect("x",value.x); }
+reflect_encode_type((hasher)) { reflect("x",value.x); }
+reflect_template((typename T),(delta<T>)) { reflect("x",value.x); }
+reflect_type((fields)) { reflect("x",value.x); }
+
+// fields named like reflect's members, declared out of alphabetical order
+struct record {
+    reflect_fields(
+        ((int),pool),
+        ((std::string),cached),
+        ((field),field_),
+        ((std::vector<int>),decode))
+};
+
+template<typename T>
+static bool round_trip(const T& value, const char* expected) {
+    std::vector<char> out;
+    reflect::vector_writer writer(out);
+    json::encoder encoder(writer);
+    encoder(value);
+    const std::string s(out.begin(),out.end());
+    if (s != expected) return false;
+    T decoded {};
+    reflect::string_reader reader(s);
+    json::decoder decoder(reader);
+    return decoder(decoded) and not decoder.error() and decoded.x == value.x;
+}
+
+int main() {
+    check(round_trip(field{1},R"({"x":1})"));
+    check(round_trip(cached{2},R"({"x":2})"));
+    check(round_trip(pool{3},R"({"x":3})"));
+    check(round_trip(hasher{4},R"({"x":4})"));
+    check(round_trip(delta<int>{5},R"({"x":5})"));
+    check(round_trip(fields{6},R"({"x":6})"));
+
+    {   // fields are counted and visited in the order of declaration
+        static_assert(reflect::fields<record>::size == 4);
+        static_assert(reflect::fields<fields>::size == 0);
+        static_assert(reflect::has_fields_v<record>);
+        static_assert(not reflect::has_fields_v<field>);
+        record r {1,"two",{3},{4}};
+        std::string names;
+        std::vector<const void*> members;
+        reflect::for_each_field(r,[&](reflect::substring name, auto& member){
+            names.append(name.begin(),name.size()).append(" ");
+            members.push_back(&member);
+        });
+        check(names == "pool cached field_ decode ");
+        check(members == std::vector<const void*>({&r.pool,&r.cached,&r.field_,&r.decode}));
+        const record& c = r;
+        size_t n = 0;
+        reflect::for_each_field(c,[&](reflect::substring, const auto&){ n += 1; });
+        check(n == 4);
+    }
+
+    return check_result("names");
+}
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+//  pmr: elements decoded into std::pmr containers, at any depth, allocate
+//  from the container's memory resource and never from the default one.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <memory_resource>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+// counts what is allocated from it, e.g. when installed as the default
+struct counting_resource : std::pmr::memory_resource {
+    size_t allocations = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations += 1;
+        return std::pmr::new_delete_resource()->allocate(bytes,alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p,bytes,alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+template<typename T>
+static bool decode(const std::string& in, T& value) {
+    reflect::string_reader reader(in);
+    json::decoder decoder(reader);
+    return decoder(value) and not decoder.error();
+}
+
+int main() {
+    counting_resource fallback;
+    std::pmr::memory_resource* const previous =
+        std::pmr::set_default_resource(&fallback);
+
+    // an arena which cannot grow, so any allocation beyond it throws
+    alignas(std::max_align_t) static char buffer[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer,sizeof(buffer),std::pmr::null_memory_resource());
+
+    {   // strings in a vector, long enough to be allocated
+        std::pmr::vector<std::pmr::string> v(&arena);
+        check(decode(R"(["a string too long for small string storage",)"
+                     R"("another string too long for small strings"])",v));
+        check(v.size() == 2 and v[1] == "another string too long for small strings");
+        for (const auto& s : v) {
+            check(s.get_allocator().resource() == &arena);
+        }
+    }
+
+    {   // keys and values of a map, and the elements of those values
+        std::pmr::map<std::pmr::string,std::pmr::vector<std::pmr::string>> m(&arena);
+        check(decode(R"({"a key long enough to need an allocation":)"
+                     R"(["and a value long enough to need one too"],)"
+                     R"("b":["x","yet another value too long for small strings"]})",m));
+        check(m.size() == 2 and m.find("b")->second.size() == 2);
+        bool all = true;
+        for (const auto& [key,values] : m) {
+            all = all and key.get_allocator().resource() == &arena;
+            all = all and values.get_allocator().resource() == &arena;
+            for (const auto& s : values) {
+                all = all and s.get_allocator().resource() == &arena;
+            }
+        }
+        check(all);
+    }
+
+    {   // nested vectors
+        std::pmr::vector<std::pmr::vector<std::pmr::string>> v(&arena);
+        check(decode(R"([["one string too long for small string storage"],[]])",v));
+        check(v.size() == 2 and v[0].size() == 1 and v[1].empty());
+        check(v[0].get_allocator().resource() == &arena);
+        check(v[0][0].get_allocator().resource() == &arena);
+    }
+
+    check(fallback.allocations == 0);
+    std::pmr::set_default_resource(previous);
+
+    return check_result("pmr");
+}
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+//  pool: items are reused from the thread's cache, then the shared list,
+//  statistics account for each, a warm pool of sessions handles messages
+//  without allocating for the codecs, and pools are safe to share between
+//  threads and to destroy while other threads still cache their items.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/pool.hpp>
+#include <reflect/codecs/json/session.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+static std::atomic<long> allocations {0};
+
+void* operator new(size_t n) {
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    if (void* p = malloc(n)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct message {
+    reflect_fields(
+        ((std::string),name),
+        ((std::vector<double>),v),
+        ((long),id))
+};
+
+static const std::string body =
+    R"({"name":"a request for a long enough name","v":[1,2,3],"id":7})";
+
+static bool handle(json::session& s) {
+    s.text = body;
+    reflect::string_reader reader(s.text);
+    s.decoder.reset(reader);
+    message m;
+    if (not s.decoder(m) or s.decoder.error()) return false;
+    reflect::vector_writer writer(s.buffer);
+    s.encoder.reset(writer);
+    s.encoder(m);
+    return std::string_view(s.buffer.data(),s.buffer.size()) == body;
+}
+
+static bool handle_fresh() {
+    json::session s;
+    return handle(s);
+}
+
+static long allocations_per(int n, bool (*f)(reflect::pool<json::session>&),
+    reflect::pool<json::session>& pool)
+{
+    const long before = allocations.load();
+    for (int i = 0; i < n; ++i) f(pool);
+    return (allocations.load() - before) / n;
+}
+
+int main() {
+    // statistics of a single thread
+    {
+        reflect::pool<json::session> pool(2,3);
+        {
+            auto a = pool.acquire(), b = pool.acquire(), c = pool.acquire();
+            auto d = pool.acquire(), e = pool.acquire(), f = pool.acquire();
+        } // 2 kept by the thread, 3 shared, 1 discarded
+        auto s = pool.statistics();
+        check(s.acquired == 6 and s.created == 6 and s.discarded == 1);
+        {
+            auto a = pool.acquire(), b = pool.acquire(), c = pool.acquire();
+        }
+        s = pool.statistics();
+        check(s.thread_hits == 2 and s.shared_hits == 1 and s.created == 6);
+
+        // another thread takes shared items, returned to the shared list
+        // when it exits
+        std::thread([&]{
+            auto a = pool.acquire(), b = pool.acquire(), c = pool.acquire();
+        }).join();
+        s = pool.statistics();
+        check(s.shared_hits == 4 and s.created == 6);
+
+        // leases move, and release early
+        auto l = pool.acquire();
+        auto m = std::move(l);
+        check(not l and m);
+        m = pool.acquire();
+        m.release();
+        check(not m);
+
+        // released items are reset, keeping their capacity
+        json::session* item = nullptr;
+        {
+            auto s = pool.acquire();
+            s->buffer.resize(1000);
+            item = s.get();
+        }
+        auto s2 = pool.acquire();
+        check(s2.get() == item);
+        check(s2->buffer.empty() and s2->buffer.capacity() >= 1000);
+        check(pool.statistics().high_water >= 1000);
+    }
+
+    // a warm pool's sessions handle messages without allocating, but for
+    // the message's name and array
+    {
+        reflect::pool<json::session> pool;
+        auto pooled = [](reflect::pool<json::session>& pool) {
+            auto s = pool.acquire();
+            return handle(*s);
+        };
+        auto fresh = [](reflect::pool<json::session>&) {
+            return handle_fresh();
+        };
+        check(pooled(pool) and fresh(pool));
+        const long warm = allocations_per(100,pooled,pool);
+        const long cold = allocations_per(100,fresh,pool);
+        check(warm == 2);
+        check(warm < cold);
+    }
+
+    // a pool destroyed while another thread caches one of its items
+    {
+        std::atomic<int> phase {0};
+        std::optional<reflect::pool<json::session>> pool;
+        pool.emplace();
+        bool created_once = false;
+        std::thread thread([&]{
+            { auto s = pool->acquire(); }
+            phase = 1;
+            while (phase != 2) std::this_thread::yield();
+            reflect::pool<json::session> other;
+            { auto s = other.acquire(); }
+            created_once = other.statistics().created == 1;
+        });
+        while (phase != 1) std::this_thread::yield();
+        pool.reset();
+        phase = 2;
+        thread.join();
+        check(created_once);
+    }
+
+    // threads sharing a pool
+    {
+        reflect::pool<json::session> pool(1,2);
+        std::atomic<int> handled {0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&]{
+                for (int i = 0; i < 500; ++i) {
+                    auto a = pool.acquire(), b = pool.acquire();
+                    handled += handle(*a) + handle(*b);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        const auto s = pool.statistics();
+        check(handled == 8000);
+        check(s.acquired == 8000);
+        check(s.thread_hits + s.shared_hits + s.created == s.acquired);
+    }
+
+    return check_result("pool");
+}
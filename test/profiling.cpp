@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+//  profiling: profiling_codec counts every value it sees, by type and by
+//  field, when decoding and encoding, and attributes the bytes of each.
+//
+#include <reflect/reflect.std.map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <reflect/profiling_codec.hpp>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct point {
+    reflect_fields(
+        ((int),x),
+        ((int),y))
+};
+
+struct shape {
+    reflect_fields(
+        ((std::string),name),
+        ((std::vector<point>),points),
+        ((std::map<std::string,int>),tags))
+};
+
+template<typename T>
+static const reflect::profile::type_timing* timing(const reflect::profile& p) {
+    const auto name = reflect::nameof<T>();
+    const auto itr = p.types().find(std::string_view(name.begin(),name.size()));
+    return itr == p.types().end() ? nullptr : &itr->second;
+}
+
+static size_t calls(const reflect::profile::type_timing* t, const char* field) {
+    if (not t) return 0;
+    const auto itr = t->fields.find(field);
+    return itr == t->fields.end() ? 0 : itr->second.calls;
+}
+
+// checks the counts common to decoding and encoding the shape below
+static void check_counts(const reflect::profile& p, size_t bytes) {
+    const auto s = timing<shape>(p);
+    const auto v = timing<point>(p);
+    const auto i = timing<int>(p);
+    check(s and s->calls == 1 and s->bytes == bytes);
+    check(calls(s,"name") == 1 and calls(s,"points") == 1 and calls(s,"tags") == 1);
+    check(v and v->calls == 3);
+    check(calls(v,"x") == 3 and calls(v,"y") == 3);
+    check(i and i->calls == 8); // six coordinates and two tags
+    check(i and i->self <= i->total and s->self <= s->total);
+    check(s->active == 0 and v->active == 0);
+}
+
+int main() {
+    const std::string in =
+        R"({"name":"tri","points":[{"x":0,"y":0},{"x":4,"y":0},{"x":0,"y":3}],)"
+        R"("tags":{"a":1,"b":2}})";
+
+    {   // decoding records each value once, but not the end of arrays
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        reflect::profile profile;
+        reflect::profiling_codec profiler(decoder,profile);
+        shape s;
+        check(profiler(s) and not decoder.error());
+        check(s.points.size() == 3 and s.points[1].x == 4 and s.tags["b"] == 2);
+        check_counts(profile,in.size());
+    }
+
+    {   // encoding records the same values, and the bytes written
+        shape s;
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        decoder(s);
+        std::vector<char> out;
+        reflect::vector_writer writer(out);
+        json::encoder encoder(writer);
+        reflect::profile profile;
+        reflect::profiling_codec profiler(encoder,profile);
+        profiler(s);
+        check(std::string(out.begin(),out.end()) == in);
+        check_counts(profile,out.size());
+        check(profile.types().size() == 6);
+        // encoded entries of maps are keyed by data, not by schema
+        check(calls(timing<std::map<std::string,int>>(profile),"[]") == 2);
+    }
+
+    {   // traces hold an event per value, and clear() forgets everything
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        reflect::profile profile(true);
+        reflect::profiling_codec profiler(decoder,profile);
+        shape s;
+        profiler(s);
+        std::ostringstream trace;
+        profile.write_trace(trace);
+        size_t events = 0;
+        for (size_t at = 0; (at = trace.str().find("\"ph\":\"X\"",at)) != std::string::npos; ++at) {
+            events += 1;
+        }
+        // the shape, its name, points and tags, 3 points of 2 ints, 2 tags
+        check(events == 1 + 3 + 3 * 3 + 2);
+        profile.clear();
+        check(profile.types().empty());
+    }
+
+    return check_result("profiling");
+}
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+//  push_decoder: values split across chunks at every offset decode the same
+//  as whole, and the capacity bounds each value however it is chunked.  The
+//  elements of a top-level array decode one at a time, within a capacity
+//  smaller than the array.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/push_decoder.hpp>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct message {
+    reflect_fields(
+        ((std::string),text),
+        ((std::vector<int>),values))
+};
+
+static const std::string stream =
+    R"({"text":"a \"quoted\" \\ value","values":[1,2,3]})" "\n"
+    R"({"text":"{not [an aggregate","values":[]})" "\n"
+    R"(  {"values":[40,50],"text":""})";
+
+static std::vector<message> decode(size_t chunk, size_t capacity = 1 << 20) {
+    std::vector<message> decoded;
+    message m;
+    json::push_decoder<message> decoder(m,capacity);
+    auto consumer = [&](message& m){
+        decoded.push_back(m);
+        m = message();
+    };
+    for (size_t i = 0; i < stream.size(); i += chunk) {
+        decoder.feed(stream.data()+i,std::min(chunk,stream.size()-i),consumer);
+    }
+    decoder.finish(consumer);
+    if (decoder.error()) decoded.clear();
+    return decoded;
+}
+
+//  Feeds s in chunks of the given size, returning the ints decoded, or -1
+//  after them if an error was reported.
+template<typename Syntax = json::syntax::lenient>
+static std::vector<int> decode_ints(
+    const std::string& s, json::framing framing, size_t chunk = 1,
+    size_t capacity = 1 << 20)
+{
+    std::vector<int> decoded;
+    int n = 0;
+    json::push_decoder<int,json::basic_decoder<Syntax>>
+        decoder(n,capacity,framing);
+    auto consumer = [&](int& n){ decoded.push_back(n); };
+    for (size_t i = 0; i < s.size(); i += chunk) {
+        decoder.feed(s.data()+i,std::min(chunk,s.size()-i),consumer);
+    }
+    decoder.finish(consumer);
+    if (decoder.error()) decoded.push_back(-1);
+    return decoded;
+}
+
+using ints = std::vector<int>;
+
+int main() {
+    const auto whole = decode(stream.size());
+    check(whole.size() == 3);
+    check(whole.size() == 3 and whole[0].text == "a \"quoted\" \\ value");
+    check(whole.size() == 3 and whole[2].values == std::vector<int>({40,50}));
+
+    for (size_t chunk = 1; chunk < stream.size(); ++chunk) {
+        const auto chunked = decode(chunk);
+        bool same = chunked.size() == whole.size();
+        for (size_t i = 0; same and i < whole.size(); ++i) {
+            same = chunked[i].text == whole[i].text
+               and chunked[i].values == whole[i].values;
+        }
+        check(same);
+    }
+
+    {   // a trailing top-level number is only delimited by finish()
+        int n = 0, count = 0;
+        json::push_decoder<int> decoder(n);
+        count += int(decoder.feed("12 3",4,[](int&){}));
+        check(count == 1 and n == 12);
+        count += int(decoder.finish([](int&){}));
+        check(count == 2 and n == 3);
+    }
+
+    {   // a value larger than capacity is an error, even in a single chunk
+        int n = 0;
+        json::push_decoder<int> decoder(n,4);
+        check(decoder.feed("123 45678 9",11) == 1);
+        check(bool(decoder.error()));
+        check(decoder.buffered() <= 5);
+    }
+
+    {   // a value larger than capacity is an error before it completes
+        std::string s;
+        json::push_decoder<std::string> decoder(s,8);
+        decoder.feed("\"abcdef",7);
+        check(not decoder.error());
+        decoder.feed("ghijklmnopqrstuvwxyz",20);
+        check(bool(decoder.error()));
+        check(decoder.buffered() <= 9);
+    }
+
+    {   // values of exactly capacity bytes decode
+        std::string s;
+        json::push_decoder<std::string> decoder(s,8);
+        check(decoder.feed("\"abcdef\"\"ghijkl\"",16) == 2);
+        check(not decoder.error() and s == "ghijkl");
+    }
+
+    // only whitespace separates top-level values
+    const auto values = json::framing::values;
+    check(decode_ints("1 2\n3",values) == ints({1,2,3}));
+    check(decode_ints("1,2",values) == ints({1,-1}));
+    check(decode_ints<json::syntax::rfc8259>("1,,2",values) == ints({1,-1}));
+
+    // the elements of top-level arrays
+    const auto elements = json::framing::elements;
+    const std::string array = " [1, 22 ,333,\n4444][] [5]";
+    for (size_t chunk = 1; chunk <= array.size(); ++chunk) {
+        check(decode_ints(array,elements,chunk,5) == ints({1,22,333,4444,5}));
+    }
+    check(decode_ints("[1,/* two */2]",elements) == ints({1,2}));
+    check(decode_ints("[1,2,]",elements) == ints({1,2}));
+    check(decode_ints<json::syntax::rfc8259>("[1,2,]",elements) == ints({1,2,-1}));
+    check(decode_ints("[1 2]",elements) == ints({1,-1}));
+    check(decode_ints("[1,,2]",elements) == ints({1,-1}));
+    check(decode_ints("[,1]",elements) == ints({-1}));
+    check(decode_ints("1",elements) == ints({-1}));
+    check(decode_ints("[1,2",elements) == ints({1,2,-1}));
+    check(decode_ints("[1,123456]",elements,1,4) == ints({1,-1}));
+
+    {   // a large array of objects within a small capacity
+        std::string s = "[";
+        for (int i = 0; i < 1000; ++i) {
+            s += (i ? "," : "");
+            s += R"({"text":"message )" + std::to_string(i) + R"(","values":[)"
+               + std::to_string(i) + "]}";
+        }
+        s += "]";
+        message m;
+        json::push_decoder<message> decoder(m,64,elements);
+        int count = 0;
+        bool same = true;
+        auto consumer = [&](message& m){
+            same = same and m.text == "message " + std::to_string(count)
+                and m.values == std::vector<int>({count});
+            count += 1;
+            m = message();
+        };
+        for (size_t i = 0; i < s.size(); i += 100) {
+            decoder.feed(s.data()+i,std::min<size_t>(100,s.size()-i),consumer);
+        }
+        decoder.finish(consumer);
+        check(not decoder.error());
+        check(count == 1000 and same);
+        check(decoder.buffered() == 0);
+    }
+
+    return check_result("push_decoder");
+}
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+//  size_hint: containers reserve what the decoder hints at, hints count only
+//  the elements actually present, and decoders without a size_hint() still
+//  decode containers.
+//
+#include <reflect/reflect.std.unordered_map.hpp>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+//  Yields the integers from 1 up to a limit, as a decoder would.
+struct counting_decoder {
+    int next = 1;
+    int last = 0;
+
+    bool operator()(int& value) {
+        if (next > last) return false;
+        value = next++;
+        return true;
+    }
+};
+
+//  As counting_decoder, but claims far more elements than it yields.
+struct boasting_decoder : counting_decoder {
+    size_t size_hint() const { return std::numeric_limits<size_t>::max() - 1; }
+};
+
+static_assert(not reflect::has_size_hint_v<counting_decoder>);
+static_assert(reflect::has_size_hint_v<boasting_decoder>);
+static_assert(reflect::has_size_hint_v<json::decoder>);
+
+static size_t hint(const std::string& in) {
+    reflect::string_reader reader(in);
+    json::decoder decoder(reader);
+    reader.read(); // past the opening bracket
+    return decoder.size_hint();
+}
+
+template<typename T>
+static bool decode(const std::string& in, T& value) {
+    reflect::string_reader reader(in);
+    json::decoder decoder(reader);
+    return decoder(value) and not decoder.error();
+}
+
+int main() {
+    {   // decoders without a hint decode without reserving
+        std::vector<int> v;
+        counting_decoder decoder {1,3};
+        reflect::decode<std::vector<int>>(decoder,v);
+        check(v == std::vector<int>({1,2,3}));
+    }
+
+    {   // implausible hints are ignored rather than thrown on
+        std::vector<int> v {0};
+        boasting_decoder decoder {{1,2}};
+        reflect::decode<std::vector<int>>(decoder,v);
+        check(v == std::vector<int>({0,1,2}));
+    }
+
+    {   // hints count the elements at the top level of the current array
+        check(hint(R"([1,[2,3],{"a":[4,5]},"6,7",null])") == 5);
+        check(hint(R"([ 1 , 2 ])") == 2);
+        check(hint(R"([])") == 0);
+        check(hint(R"({"a":1,"b":{"c":2}})") == 2);
+    }
+
+    {   // an array which never closes declares nothing
+        std::string in = "[";
+        for (int i = 0; i < 100000; ++i) in += "1,";
+        check(hint(in) == 0);
+        std::vector<int> v;
+        check(not decode(in,v));
+        check(v.size() == 100000 and v.capacity() < 2 * v.size());
+    }
+
+    {   // separators alone or inside strings are not elements
+        check(hint("[" + std::string(100000,',') + "]") == 0);
+        check(hint("[\"" + std::string(100000,',') + "\"]") == 1);
+    }
+
+    {   // decoding reserves exactly the elements which follow
+        std::string in = "[";
+        for (int i = 0; i < 1000; ++i) in += std::to_string(i) + ",";
+        in += "1000]";
+        std::vector<int> v;
+        check(decode(in,v) and v.size() == 1001 and v.capacity() == 1001);
+        std::unordered_map<std::string,int> m;
+        check(decode(R"({"a":1,"b":2,"c":3})",m) and m.size() == 3);
+        check(m.bucket_count() >= 3);
+    }
+
+    {   // streams are not contiguous, so give no hint
+        std::istringstream stream("[1,2,3]");
+        reflect::stream_reader reader(stream);
+        json::decoder decoder(reader);
+        reader.read();
+        check(decoder.size_hint() == 0);
+        std::istringstream again("[1,2,3]");
+        reflect::stream_reader reader2(again);
+        json::decoder decoder2(reader2);
+        std::vector<int> v;
+        check(decoder2(v) and v == std::vector<int>({1,2,3}));
+    }
+
+    return check_result("size_hint");
+}
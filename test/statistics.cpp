@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+//  statistics: with reflect_codecs_json_statistics defined to 1, which the
+//  Makefile does for this test alone, the codecs count the work they do.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <reflect/codecs/json/encoder.hpp>
+#include <string>
+#include "check.hpp"
+
+static_assert(reflect_codecs_json_statistics == 1);
+
+namespace json = reflect::codecs::json;
+
+struct pair {
+    reflect_fields(
+        ((int),a),
+        ((int),b))
+};
+
+int main() {
+    {   // fields are found by comparing keys, skipping others and seeking back
+        const std::string in = R"({"b":2,"x":[1,2],"a":1})";
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        pair p;
+        check(decoder(p) and p.a == 1 and p.b == 2);
+        const auto& s = decoder.statistics();
+        check(s.bytes_read == in.size());
+        check(s.bytes_reread > 0);
+        check(s.property_comparisons == 4);   // b x a, then b
+        check(s.skipped_values == 5);       // b x for a, then b x a at '}'
+        check(s.seeks == 2);                  // back to '{' after each field
+
+        const auto before = s;
+        reader.seek(0);
+        decoder.reset();
+        check(decoder(p));
+        check(s.bytes_read == 2 * before.bytes_read);
+        check(s.property_comparisons == 2 * before.property_comparisons);
+        check(s.seeks == 2 * before.seeks);
+    }
+
+    {   // members count once whether validated, or rescanned for comments
+        const std::string in = R"({"b":2,"x":[1,2],"a":1})";
+        reflect::string_reader reader(in);
+        json::basic_decoder<json::syntax::rfc8259> strict(reader);
+        pair p;
+        check(strict(p) and strict.statistics().skipped_values == 5);
+        const std::string commented = R"({"b":2, "x" /**/ : [1,2],"a":1})";
+        reflect::string_reader reader2(commented);
+        json::decoder decoder(reader2);
+        check(decoder(p) and decoder.statistics().skipped_values == 5);
+    }
+
+    {   // unescaping into the scratch buffer allocates only as it grows
+        const std::string in = R"(["\n","\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n","\n"])";
+        reflect::string_reader reader(in);
+        json::decoder decoder(reader);
+        std::vector<std::string> v;
+        check(decoder(v) and v.size() == 3 and v[1].size() == 32);
+        const auto& s = decoder.statistics();
+        check(s.allocations >= 1 and s.allocations <= 2);
+        check(s.skipped_values == 0);
+    }
+
+    {   // the encoder counts what it passes to the writer
+        std::vector<char> out;
+        reflect::vector_writer writer(out);
+        json::encoder encoder(writer);
+        encoder(pair{1,2});
+        const auto& s = encoder.statistics();
+        check(s.bytes_written == out.size());
+        check(s.writes > 0 and s.writes <= s.bytes_written);
+    }
+
+    return check_result("statistics");
+}
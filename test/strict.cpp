@@ -0,0 +1,82 @@
+//------------------------------------------------------------------------------
+//  strict validation: malformed JSON is rejected whether it is decoded or
+//  skipped, and lenient validation rejects malformed values it skips too,
+//  while accepting leading zeros, comments and trailing commas.
+//
+#include <string>
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+struct message {
+    reflect_fields(
+        ((int),x),
+        ((std::vector<int>),v))
+};
+
+template<typename Syntax = json::syntax::lenient>
+static bool decode(const char* s, json::validation validation) {
+    message m {};
+    reflect::string_reader reader(s);
+    json::basic_decoder<Syntax> decoder(reader,validation);
+    return decoder(m) and not decoder.error();
+}
+
+static bool strict(const char* s) {
+    return decode<json::syntax::rfc8259>(s,json::validation::strict);
+}
+
+static bool lenient(const char* s) {
+    return decode(s,json::validation::lenient);
+}
+
+int main() {
+    // valid documents
+    check(strict(R"({"x":0,"v":[0,10,-0,-10,0.5,1e3]})"));
+    check(strict(R"({"y":[1,{"a":null}],"x":1})"));
+
+    // leading zeros, decoded and skipped
+    check(not strict(R"({"x":01})"));
+    check(not strict(R"({"x":-01})"));
+    check(not strict(R"({"v":[1,00]})"));
+    check(not strict(R"({"y":01,"x":1})"));
+    check(not strict(R"({"y":[007],"x":1})"));
+    check(lenient(R"({"x":01})"));
+
+    // other malformed values, skipped
+    check(not strict(R"({"y":tru,"x":1})"));
+    check(not strict(R"({"y":[1 2],"x":1})"));
+    check(not strict(R"({"y":{"a" 1},"x":1})"));
+    check(not strict(R"({"y":[1,2},"x":1})"));
+    check(not strict(R"({"x":1} x)"));
+
+    // values skipped by lenient validation
+    check(lenient(R"({"y":[1,{"a":[true,false,null]},"\u00e9\n"],"x":1})"));
+    check(lenient(R"({"y":{"a":-1.5e+3,"b":[]},"x":1})"));
+    check(lenient(R"({"y":[1,2,],"z":{"a":1,},"x":1})"));
+    check(lenient(R"({"y":[1,/*2*/3],"x":1})"));
+    check(lenient(R"({"y":[01],"x":1})"));
+    check(not lenient(R"({"y":tru,"x":1})"));
+    check(not lenient(R"({"y":12a3,"x":1})"));
+    check(not lenient(R"({"y":[1 2 3],"x":1})"));
+    check(not lenient(R"({"y":"\q","x":1})"));
+    check(not lenient(R"({"y":{"a" 1},"x":1})"));
+    check(not lenient(R"({"y":{1:2},"x":1})"));
+    check(not lenient(R"({"y":[},"x":1})"));
+    check(not lenient(R"({"y":[1,2},"x":1})"));
+    check(not lenient(R"({"y":{"a":1],"x":1})"));
+    check(not lenient(R"({"y":[1,2)"));
+
+    // values nested beyond the scanner's depth, left to the tokenizer
+    auto nested = [](const char* inner, const char* tail) {
+        return "{\"y\":" + std::string(100,'[') + inner
+             + std::string(99,']') + tail + ",\"x\":1}";
+    };
+    check(lenient(nested("{}","]").c_str()));
+    check(not lenient(nested("{}","}").c_str()));
+    check(not lenient(nested("{]","]").c_str()));
+
+    return check_result("strict");
+}
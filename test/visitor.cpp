@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+//  visitor: visit() reports events in document order, and rejects documents
+//  nested deeper than max_depth arrays and objects.
+//
+#include <reflect/reflect.std.vector.hpp>
+#include <reflect/codecs/json/decoder.hpp>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+namespace json = reflect::codecs::json;
+
+// records events as a compact string, e.g. {k:a[n1,s"x"]}
+struct recorder : json::visitor {
+    std::string events;
+    void start_object() { events += "{"; }
+    void end_object() { events += "}"; }
+    void start_array() { events += "["; }
+    void end_array() { events += "]"; }
+    void key(reflect::substring s) { events += "k:" + std::string(s.begin(),s.end()); }
+    void null() { events += "z,"; }
+    void boolean(bool b) { events += b ? "t," : "f,"; }
+    void number(reflect::substring s) { events += "n" + std::string(s.begin(),s.end()) + ","; }
+    void string(reflect::substring s) { events += "s\"" + std::string(s.begin(),s.end()) + "\","; }
+};
+
+template<typename Syntax = json::syntax::lenient>
+static std::string visit(const std::string& in, reflect::read_error* error = nullptr) {
+    reflect::string_reader reader(in);
+    json::basic_decoder<Syntax> decoder(reader);
+    recorder r;
+    const auto e = decoder.visit(r);
+    if (error) *error = e;
+    return e ? "error" : r.events;
+}
+
+static std::string nested(size_t depth, const char* head, const char* tail) {
+    std::string s;
+    for (size_t i = 0; i < depth; ++i) s += head;
+    s += "1";
+    for (size_t i = 0; i < depth; ++i) s += tail;
+    return s;
+}
+
+int main() {
+    {   // events follow the document, depth first
+        check(visit(R"({"a":[1,{"b":null}],"c":{"d":[true,false]},"e":"x\ny"})")
+              == "{k:a[n1,{k:bz,}]k:c{k:d[t,f,]}k:es\"x\ny\",}");
+        check(visit("[[],{},[[]]]") == "[[]{}[[]]]");
+        check(visit(R"("only")") == "s\"only\",");
+    }
+
+    {   // several top level values are visited in turn
+        check(visit("1,[2],{\"a\":3}") == "n1,[n2,]{k:an3,}");
+    }
+
+    {   // streamed input produces the same events
+        const std::string in = R"({"a":[1,{"b":"A"}]})";
+        std::istringstream stream(in);
+        reflect::stream_reader reader(stream);
+        json::decoder decoder(reader);
+        recorder r;
+        check(not decoder.visit(r));
+        check(r.events == visit(in));
+    }
+
+    {   // mismatched and unterminated documents are errors
+        reflect::read_error e;
+        check(visit("[1,2}",&e) == "error" and e);
+        check(visit("{\"a\":1",&e) == "error");
+        check(std::string(e.message()) == "unexpected end of input");
+        check(visit("{1}",&e) == "error");
+    }
+
+    {   // up to max_depth arrays and objects nest, however they are mixed
+        enum { max_depth = reflect_codecs_json_decoder_max_depth };
+        reflect::read_error e;
+        check(visit(nested(max_depth,"[","]")) != "error");
+        check(visit(nested(max_depth,"{\"k\":","}")) != "error");
+        check(visit(nested(max_depth/2,"[{\"k\":","}]")) != "error");
+        check(visit(nested(max_depth+1,"[","]"),&e) == "error");
+        check(std::string(e.message()) == "maximum depth exceeded");
+        check(visit(nested(max_depth+1,"{\"k\":","}"),&e) == "error");
+        check(std::string(e.message()) == "maximum depth exceeded");
+        check(e.offset() == max_depth * 5);
+        check(visit<json::syntax::rfc8259>(nested(max_depth+1,"[","]")) == "error");
+    }
+
+    return check_result("visitor");
+}
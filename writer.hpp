@@ -1,4 +1,5 @@
 #pragma once
+#include <cstring>
 #include <ostream>
 #include <vector>
 #include "interface.hpp"
@@ -24,6 +25,13 @@ namespace reflect {
 
         virtual void write(const char*,size_t) = 0;
 
+        //  Writes bytes which the caller guarantees remain valid and unchanged
+        //  until the writer is flushed, so that a writer may reference them
+        //  rather than copy them.  Writers copy them by default.
+        virtual void write_borrowed(const char* s, size_t n) { write(s,n); }
+
+        void write_borrowed(substring s) { write_borrowed(s.begin(),s.size()); }
+
     };
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -82,17 +90,16 @@ namespace reflect {
     class vector_writer final : public writer {
         std::vector<char,Allocator>* const _vector = nullptr;
         const size_t _head = 0;
-        const size_t _offset = 0;
 
     public: // types
 
-        using vector_type = decltype(_vector);
+        using vector_type = std::vector<char,Allocator>;
 
     public: // structors
 
         vector_writer() = default;
 
-        vector_writer(vector_type& vector)
+        vector_writer(std::vector<char,Allocator>& vector)
         :_vector(&vector)
         ,_head(vector.size()) {}
 
@@ -103,20 +110,67 @@ namespace reflect {
         }
 
         size_t offset() const override {
-            return _offset;
+            return _vector ? _vector->size() - _head : 0;
+        }
+
+        void write(const char* s, size_t n) override {
+            if (operator bool()) _vector->insert(_vector->end(),s,s+n);
+        }
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Counts the bytes written without storing them, e.g. to size a buffer
+    //  exactly before encoding into it.
+    class counting_writer final : public writer {
+        size_t _count = 0;
+
+    public: // overrides
+
+        explicit operator bool() const override { return true; }
+
+        size_t offset() const override { return _count; }
+
+        void write(const char*, size_t n) override { _count += n; }
+
+    };
+
+    //--------------------------------------------------------------------------
+
+    //  Writes into a fixed buffer, e.g. a network frame or shared memory slot
+    //  sized by counting_writer.  Writes which would overflow the buffer are
+    //  dropped, and the writer is false from then on.
+    class buffer_writer final : public writer {
+        char* const _head = nullptr;
+        char* _itr = nullptr;
+        char* const _tail = nullptr;
+        bool _overflow = false;
+
+    public: // structors
+
+        buffer_writer() = default;
+
+        buffer_writer(char* data, size_t size)
+        :_head(data)
+        ,_itr(data)
+        ,_tail(data+size) {}
+
+    public: // overrides
+
+        explicit operator bool() const override {
+            return _head and not _overflow;
         }
 
+        size_t offset() const override { return size_t(_itr - _head); }
+
         void write(const char* s, size_t n) override {
-            if (operator bool()) {
-                const auto start = _vector->size();
-                const auto size = start + n;
-                _vector->resize(size+1,0);
-                char* itr = _vector->data() + start;
-                const char* const end = itr + size;
-                for (;itr < end; *itr++=*s++);
-                reflect_assert(_vector->back()=='\0');
-                _vector->resize(size);
+            if (_overflow or n > size_t(_tail - _itr)) {
+                _overflow = true;
+                return;
             }
+            memcpy(_itr,s,n);
+            _itr += n;
         }
 
     };